@@ -22,12 +22,16 @@
 	#include "config.h"
 #endif
 
+#include <string.h>
+
 #include <gtkmaskedentry.h>
 
+#include "maskcore.h"
 #include "gtkcellrenderermasked.h"
 
 static void gtk_cell_renderer_masked_init (GtkCellRendererMasked *cell);
 static void gtk_cell_renderer_masked_class_init (GtkCellRendererMaskedClass *class);
+static void gtk_cell_renderer_masked_finalize (GObject *object);
 
 
 static void gtk_cell_renderer_masked_get_property (GObject *object,
@@ -39,6 +43,33 @@ static void gtk_cell_renderer_masked_set_property (GObject *object,
                                                    const GValue *value,
                                                    GParamSpec *pspec);
 
+static void gtk_cell_renderer_masked_raw_data_func (GtkTreeViewColumn *column,
+                                                    GtkCellRenderer *cell,
+                                                    GtkTreeModel *model,
+                                                    GtkTreeIter *iter,
+                                                    gpointer data);
+static void gtk_cell_renderer_masked_cache_clear (GtkCellRendererMasked *renderer);
+static void gtk_cell_renderer_masked_pool_prune (GtkCellRendererMasked *renderer);
+static void gtk_cell_renderer_masked_row_mask_free (gpointer data);
+static void gtk_cell_renderer_masked_row_masks_trim (GtkCellRendererMasked *renderer,
+                                                     guint keep);
+static void gtk_cell_renderer_masked_cache_set_model (GtkCellRendererMasked *renderer,
+                                                      GtkTreeModel *model);
+
+static void gtk_cell_renderer_masked_get_preferred_width (GtkCellRenderer *cell,
+                                                          GtkWidget *widget,
+                                                          gint *minimum_size,
+                                                          gint *natural_size);
+static void gtk_cell_renderer_masked_get_preferred_height (GtkCellRenderer *cell,
+                                                           GtkWidget *widget,
+                                                           gint *minimum_size,
+                                                           gint *natural_size);
+static void gtk_cell_renderer_masked_get_preferred_height_for_width (GtkCellRenderer *cell,
+                                                                     GtkWidget *widget,
+                                                                     gint width,
+                                                                     gint *minimum_height,
+                                                                     gint *natural_height);
+
 static GtkCellEditable *gtk_cell_renderer_masked_start_editing (GtkCellRenderer *cell,
                                                                 GdkEvent *event,
                                                                 GtkWidget *widget,
@@ -51,9 +82,36 @@ static GtkCellEditable *gtk_cell_renderer_masked_start_editing (GtkCellRenderer
 enum
 {
 	PROP_0,
-	PROP_MASK
+	PROP_MASK,
+	PROP_RAW_TEXT,
+	PROP_ROW_MASK,
+	PROP_CACHE_SIZE,
+	PROP_SIZE_FROM_MASK,
+	PROP_WRITE_RAW
+};
+
+enum
+{
+	EDITED_RAW,
+	LAST_SIGNAL
 };
 
+static guint signals[LAST_SIGNAL] = { 0 };
+
+/* the rows whose formatted text is kept by default */
+#define GTK_CELL_RENDERER_MASKED_CACHE_SIZE 1024
+
+/* the idle editors kept for every compiled mask */
+#define GTK_CELL_RENDERER_MASKED_POOL_SIZE 4
+
+/* the masks of the rows kept compiled */
+#define GTK_CELL_RENDERER_MASKED_ROW_MASKS 64
+
+#define GTK_CELL_RENDERER_MASKED_EDITOR_MASK "gtk-cell-renderer-masked-editor-mask"
+
+/* the model of the view being edited, where "write-raw" writes */
+#define GTK_CELL_RENDERER_MASKED_EDITOR_MODEL "gtk-cell-renderer-masked-editor-model"
+
 static gpointer parent_class;
 
 #define GTK_CELL_RENDERER_TEXT_PATH "gtk-cell-renderer-text-path"
@@ -63,11 +121,63 @@ static gpointer parent_class;
 typedef struct _GtkCellRendererMaskedPrivate GtkCellRendererMaskedPrivate;
 struct _GtkCellRendererMaskedPrivate
 {
-	gchar *mask;
+	MaskCore *mask;
 
 	GtkWidget *entry;
+
+	/* the column of the model with the values without the mask, see
+	 * gtk_cell_renderer_masked_set_raw_column(), and whether the edited
+	 * values go straight into it */
+	gint raw_column;
+	gboolean write_raw;
+
+	/* the formatted text of the last rows shown, most recently used first;
+	 * the rows are found by their iter, that must persist, and forgotten
+	 * when they change or when the stamp of the model changes */
+	GtkTreeModel *cache_model;
+	gint cache_stamp;
+	guint cache_size;
+	GHashTable *cache;
+	GQueue cache_lru;
+
+	/* the editors made, each holding a reference, and the idle ones by
+	 * compiled mask, ready for the next edit */
+	GSList *editors;
+	GHashTable *pool;
+
+	/* the mask of the row being rendered, if any, instead of mask; the
+	 * masks compiled for the last rows, by text, most recently used first */
+	MaskCore *row_mask;
+	GHashTable *row_masks;
+	GQueue row_masks_lru;
+
+	/* the size taken by the masks, measured once for a font: the widest
+	 * character of every class, and the masks with them; -1 when the masks
+	 * are to be measured again */
+	gboolean size_from_mask;
+	PangoFontDescription *size_font;
+	gchar size_widest[256];
+	gint size_width;
+	gint size_height;
 };
 
+/* the mask the row being rendered or edited is formatted with */
+#define GTK_CELL_RENDERER_MASKED_CURRENT_MASK(priv) \
+	((priv)->row_mask != NULL ? (priv)->row_mask : (priv)->mask)
+
+typedef struct
+{
+	GtkTreeIter iter;
+	GList link;
+	gchar text[1];
+} GtkCellRendererMaskedCached;
+
+typedef struct
+{
+	MaskCore *mask;
+	GList link;
+} GtkCellRendererMaskedRowMask;
+
 G_DEFINE_TYPE (GtkCellRendererMasked, gtk_cell_renderer_masked, GTK_TYPE_CELL_RENDERER_TEXT)
 
 static void
@@ -75,7 +185,65 @@ gtk_cell_renderer_masked_init (GtkCellRendererMasked *cell)
 {
   GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (cell);
 
-  priv->mask = g_strdup ("");
+  priv->mask = mask_core_intern ("");
+  priv->raw_column = -1;
+  priv->cache_model = NULL;
+  priv->cache_stamp = 0;
+  priv->cache_size = GTK_CELL_RENDERER_MASKED_CACHE_SIZE;
+  priv->cache = NULL;
+  g_queue_init (&priv->cache_lru);
+  priv->editors = NULL;
+  priv->pool = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                      (GDestroyNotify)mask_core_unref,
+                                      (GDestroyNotify)g_queue_free);
+  priv->row_mask = NULL;
+  priv->row_masks = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                           NULL,
+                                           gtk_cell_renderer_masked_row_mask_free);
+  g_queue_init (&priv->row_masks_lru);
+  priv->write_raw = FALSE;
+  priv->size_from_mask = FALSE;
+  priv->size_font = NULL;
+  priv->size_width = -1;
+  priv->size_height = -1;
+}
+
+/* VOID:STRING,STRING, as glib-genmarshal writes it */
+static void
+gtk_cell_renderer_masked_marshal_VOID__STRING_STRING (GClosure *closure,
+                                                      GValue *return_value,
+                                                      guint n_param_values,
+                                                      const GValue *param_values,
+                                                      gpointer invocation_hint,
+                                                      gpointer marshal_data)
+{
+	typedef void (*GMarshalFunc_VOID__STRING_STRING) (gpointer data1,
+	                                                  const gchar *arg_1,
+	                                                  const gchar *arg_2,
+	                                                  gpointer data2);
+
+	GCClosure *cc = (GCClosure *)closure;
+	GMarshalFunc_VOID__STRING_STRING callback;
+	gpointer data1, data2;
+
+	g_return_if_fail (n_param_values == 3);
+
+	if (G_CCLOSURE_SWAP_DATA (closure))
+		{
+			data1 = closure->data;
+			data2 = g_value_peek_pointer (param_values + 0);
+		}
+	else
+		{
+			data1 = g_value_peek_pointer (param_values + 0);
+			data2 = closure->data;
+		}
+	callback = (GMarshalFunc_VOID__STRING_STRING)(marshal_data ? marshal_data : cc->callback);
+
+	callback (data1,
+	          g_value_get_string (param_values + 1),
+	          g_value_get_string (param_values + 2),
+	          data2);
 }
 
 static void
@@ -88,7 +256,11 @@ gtk_cell_renderer_masked_class_init (GtkCellRendererMaskedClass *class)
 
 	object_class->get_property = gtk_cell_renderer_masked_get_property;
 	object_class->set_property = gtk_cell_renderer_masked_set_property;
+	object_class->finalize = gtk_cell_renderer_masked_finalize;
 
+	cell_class->get_preferred_width = gtk_cell_renderer_masked_get_preferred_width;
+	cell_class->get_preferred_height = gtk_cell_renderer_masked_get_preferred_height;
+	cell_class->get_preferred_height_for_width = gtk_cell_renderer_masked_get_preferred_height_for_width;
 	cell_class->start_editing = gtk_cell_renderer_masked_start_editing;
 
 	g_object_class_install_property (object_class,
@@ -99,6 +271,67 @@ gtk_cell_renderer_masked_class_init (GtkCellRendererMaskedClass *class)
                                                         NULL,
                                                         G_PARAM_READWRITE));
 
+	g_object_class_install_property (object_class,
+                                   PROP_RAW_TEXT,
+                                   g_param_spec_string ("raw-text",
+                                                        "Text without the mask",
+                                                        "Text without the mask, formatted with the mask when rendered",
+                                                        NULL,
+                                                        G_PARAM_WRITABLE));
+
+	g_object_class_install_property (object_class,
+                                   PROP_ROW_MASK,
+                                   g_param_spec_string ("row-mask",
+                                                        "Row mask",
+                                                        "Mask of the row, instead of the mask of the column; to be bound to a model column",
+                                                        NULL,
+                                                        G_PARAM_READWRITE));
+
+	g_object_class_install_property (object_class,
+                                   PROP_CACHE_SIZE,
+                                   g_param_spec_uint ("cache-size",
+                                                      "Cache size",
+                                                      "The number of rows whose formatted text is kept",
+                                                      0, G_MAXUINT,
+                                                      GTK_CELL_RENDERER_MASKED_CACHE_SIZE,
+                                                      G_PARAM_READWRITE));
+
+	g_object_class_install_property (object_class,
+                                   PROP_WRITE_RAW,
+                                   g_param_spec_boolean ("write-raw",
+                                                         "Write the value without the mask",
+                                                         "Whether an edited value is written without the mask in the column set with gtk_cell_renderer_masked_set_raw_column(), instead of emitting \"edited\" and \"edited-raw\"",
+                                                         FALSE,
+                                                         G_PARAM_READWRITE));
+
+	g_object_class_install_property (object_class,
+                                   PROP_SIZE_FROM_MASK,
+                                   g_param_spec_boolean ("size-from-mask",
+                                                         "Size from the mask",
+                                                         "Whether the size is the one of the mask filled with its widest characters, measured once for a font, instead of the one of the text of every row",
+                                                         FALSE,
+                                                         G_PARAM_READWRITE));
+
+	/**
+	 * GtkCellRendererMasked::edited-raw:
+	 * @renderer: the object which received the signal.
+	 * @path: the path identifying the edited cell.
+	 * @raw_text: the new value, without the mask.
+	 *
+	 * Emitted after #GtkCellRendererText::edited, with the value as the
+	 * editor keeps it, without literals and placeholders.
+	 */
+	signals[EDITED_RAW] =
+		g_signal_new ("edited-raw",
+		              G_OBJECT_CLASS_TYPE (object_class),
+		              G_SIGNAL_RUN_LAST,
+		              G_STRUCT_OFFSET (GtkCellRendererMaskedClass, edited_raw),
+		              NULL, NULL,
+		              gtk_cell_renderer_masked_marshal_VOID__STRING_STRING,
+		              G_TYPE_NONE, 2,
+		              G_TYPE_STRING,
+		              G_TYPE_STRING);
+
 	g_type_class_add_private (object_class, sizeof (GtkCellRendererMaskedPrivate));
 }
 
@@ -116,7 +349,27 @@ gtk_cell_renderer_masked_get_property (GObject *object,
 	switch (param_id)
 		{
 			case PROP_MASK:
-				g_value_set_string (value, priv->mask);
+				g_value_set_string (value, priv->mask->text);
+				break;
+
+			case PROP_ROW_MASK:
+				g_value_set_string (value, priv->row_mask != NULL ? priv->row_mask->text : NULL);
+				break;
+
+			case PROP_SIZE_FROM_MASK:
+				g_value_set_boolean (value, priv->size_from_mask);
+				break;
+
+			case PROP_WRITE_RAW:
+				g_value_set_boolean (value, priv->write_raw);
+				break;
+
+			case PROP_CACHE_SIZE:
+				g_value_set_uint (value, priv->cache_size);
+				break;
+
+			default:
+				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
 				break;
 		}
 }
@@ -128,6 +381,7 @@ gtk_cell_renderer_masked_set_property (GObject *object,
                                        GParamSpec *pspec)
 {
 	GtkCellRendererMasked *celltext = GTK_CELL_RENDERER_MASKED (object);
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (object);
 
 	switch (param_id)
 		{
@@ -136,6 +390,45 @@ gtk_cell_renderer_masked_set_property (GObject *object,
 					gtk_cell_renderer_masked_set_mask (celltext, g_value_get_string (value));
 					break;
 				}
+
+			case PROP_RAW_TEXT:
+				{
+					const gchar *raw = g_value_get_string (value);
+					gchar *text;
+
+					if (raw == NULL || raw[0] == '\0')
+						{
+							g_object_set (object, "text", raw, NULL);
+							break;
+						}
+
+					text = g_new (gchar, MASK_CORE_FORMATTED_SIZE (GTK_CELL_RENDERER_MASKED_CURRENT_MASK (priv)));
+					mask_core_format (GTK_CELL_RENDERER_MASKED_CURRENT_MASK (priv), raw, -1, text);
+					g_object_set (object, "text", text, NULL);
+					g_free (text);
+					break;
+				}
+
+			case PROP_ROW_MASK:
+				gtk_cell_renderer_masked_set_row_mask (celltext, g_value_get_string (value));
+				break;
+
+			case PROP_CACHE_SIZE:
+				priv->cache_size = g_value_get_uint (value);
+				gtk_cell_renderer_masked_cache_clear (celltext);
+				break;
+
+			case PROP_SIZE_FROM_MASK:
+				priv->size_from_mask = g_value_get_boolean (value);
+				break;
+
+			case PROP_WRITE_RAW:
+				priv->write_raw = g_value_get_boolean (value);
+				break;
+
+			default:
+				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
+				break;
 		}
 }
 
@@ -144,6 +437,11 @@ gtk_cell_renderer_masked_set_property (GObject *object,
  *
  * Creates a new #GtkCellRendererMasked widget.
  *
+ * The #GtkMaskedEntry editors are kept once an edit is done and used again
+ * for the next edits with the same mask: the handlers connected to the
+ * editor in #GtkCellRenderer::editing-started must be disconnected when the
+ * edit is done, otherwise they stay for the following ones.
+ *
  * Returns: the newly created #GtkCellRendererMasked
  */
 GtkCellRenderer
@@ -170,11 +468,40 @@ GtkCellRenderer
 	return r;
 }
 
+/* the value without the mask into the model shown through the raw column,
+ * for the stores only: FALSE for other models */
+static gboolean
+gtk_cell_renderer_masked_write_raw (GtkTreeModel *model,
+                                    const gchar *path,
+                                    gint column,
+                                    const gchar *raw_text)
+{
+	GtkTreeIter iter;
+
+	if (model == NULL
+	    || !(GTK_IS_LIST_STORE (model) || GTK_IS_TREE_STORE (model))
+	    || !gtk_tree_model_get_iter_from_string (model, &iter, path))
+		{
+			return FALSE;
+		}
+
+	if (GTK_IS_LIST_STORE (model))
+		{
+			gtk_list_store_set (GTK_LIST_STORE (model), &iter, column, raw_text, -1);
+		}
+	else
+		{
+			gtk_tree_store_set (GTK_TREE_STORE (model), &iter, column, raw_text, -1);
+		}
+
+	return TRUE;
+}
+
 static void
 gtk_cell_renderer_masked_editing_done (GtkCellEditable *entry,
                                        gpointer data)
 {
-	const gchar *path, *new_text;
+	const gchar *path, *new_text, *raw_text;
 
 	gboolean editing_canceled;
 
@@ -189,9 +516,421 @@ gtk_cell_renderer_masked_editing_done (GtkCellEditable *entry,
 		return;
 
 	path = g_object_get_data (G_OBJECT (entry), GTK_CELL_RENDERER_TEXT_PATH);
+	raw_text = gtk_masked_entry_get_text (GTK_MASKED_ENTRY (entry));
+
+	if (priv->write_raw
+	    && priv->raw_column >= 0
+	    && gtk_cell_renderer_masked_write_raw (g_object_get_data (G_OBJECT (entry), GTK_CELL_RENDERER_MASKED_EDITOR_MODEL),
+	                                           path, priv->raw_column, raw_text))
+		{
+			return;
+		}
+
 	new_text = gtk_entry_get_text (GTK_ENTRY (entry));
 
 	g_signal_emit_by_name (data, "edited", path, new_text);
+	g_signal_emit (data, signals[EDITED_RAW], 0, path, raw_text);
+}
+
+/*
+ * the size from the mask: every position of the masks of the column and of
+ * the rows known filled with the widest character it accepts
+ */
+static PangoFontDescription
+*gtk_cell_renderer_masked_get_font (GtkCellRenderer *cell,
+                                    GtkWidget *widget)
+{
+	PangoFontDescription *font;
+	PangoFontDescription *cell_font;
+	gboolean scale_set;
+	gdouble scale;
+
+	font = pango_font_description_copy (pango_context_get_font_description (gtk_widget_get_pango_context (widget)));
+
+	g_object_get (G_OBJECT (cell),
+	              "font-desc", &cell_font,
+	              "scale-set", &scale_set,
+	              "scale", &scale,
+	              NULL);
+	pango_font_description_merge (font, cell_font, TRUE);
+	pango_font_description_free (cell_font);
+
+	if (scale_set)
+		{
+			if (pango_font_description_get_size_is_absolute (font))
+				{
+					pango_font_description_set_absolute_size (font, pango_font_description_get_size (font) * scale);
+				}
+			else
+				{
+					pango_font_description_set_size (font, pango_font_description_get_size (font) * scale);
+				}
+		}
+
+	return font;
+}
+
+static void
+gtk_cell_renderer_masked_measure_mask (PangoLayout *layout,
+                                       const gchar *widest,
+                                       const MaskCore *mask,
+                                       gint *width,
+                                       gint *height)
+{
+	gchar *text;
+	gint i, w, h;
+
+	text = g_new (gchar, MASK_CORE_FORMATTED_SIZE (mask));
+	for (i = 0; i < mask->length; i++)
+		{
+			text[i] = (mask->classes[i] == MASK_CORE_CLASS_LITERAL ? mask->literals[i] : widest[mask->classes[i]]);
+		}
+	text[mask->length] = '\0';
+
+	pango_layout_set_text (layout, text, mask->length);
+	pango_layout_get_pixel_size (layout, &w, &h);
+	*width = MAX (*width, w);
+	*height = MAX (*height, h);
+
+	g_free (text);
+}
+
+static void
+gtk_cell_renderer_masked_update_size (GtkCellRenderer *cell,
+                                      GtkWidget *widget)
+{
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (cell);
+
+	PangoFontDescription *font;
+	PangoLayout *layout;
+	GHashTableIter iter;
+	gpointer row_mask;
+	gint cls, n_classes, w, widths[256];
+	gchar c;
+
+	font = gtk_cell_renderer_masked_get_font (cell, widget);
+	if (priv->size_font != NULL && pango_font_description_equal (font, priv->size_font))
+		{
+			pango_font_description_free (font);
+			if (priv->size_width >= 0)
+				{
+					return;
+				}
+		}
+	else
+		{
+			if (priv->size_font != NULL)
+				{
+					pango_font_description_free (priv->size_font);
+				}
+			priv->size_font = font;
+			priv->size_width = -1;
+		}
+
+	layout = gtk_widget_create_pango_layout (widget, NULL);
+	pango_layout_set_font_description (layout, priv->size_font);
+
+	/* the widest character of every class, the placeholder included, from
+	 * the characters shown as they are typed */
+	n_classes = mask_core_get_n_classes ();
+	for (cls = 0; cls < n_classes; cls++)
+		{
+			priv->size_widest[cls] = MASK_CORE_PLACEHOLDER;
+			widths[cls] = -1;
+		}
+	for (c = ' '; c <= '~'; c++)
+		{
+			w = -1;
+			for (cls = MASK_CORE_CLASS_DIGIT; cls < n_classes; cls++)
+				{
+					if (c != MASK_CORE_PLACEHOLDER && mask_core_class_lookup (cls, c) != c)
+						{
+							continue;
+						}
+
+					if (w < 0)
+						{
+							pango_layout_set_text (layout, &c, 1);
+							pango_layout_get_pixel_size (layout, &w, NULL);
+						}
+					if (w > widths[cls])
+						{
+							widths[cls] = w;
+							priv->size_widest[cls] = c;
+						}
+				}
+		}
+
+	priv->size_width = 0;
+	priv->size_height = 0;
+	gtk_cell_renderer_masked_measure_mask (layout, priv->size_widest, priv->mask,
+	                                       &priv->size_width, &priv->size_height);
+	g_hash_table_iter_init (&iter, priv->row_masks);
+	while (g_hash_table_iter_next (&iter, NULL, &row_mask))
+		{
+			gtk_cell_renderer_masked_measure_mask (layout, priv->size_widest,
+			                                       ((GtkCellRendererMaskedRowMask *)row_mask)->mask,
+			                                       &priv->size_width, &priv->size_height);
+		}
+
+	g_object_unref (layout);
+}
+
+static void
+gtk_cell_renderer_masked_get_preferred_width (GtkCellRenderer *cell,
+                                              GtkWidget *widget,
+                                              gint *minimum_size,
+                                              gint *natural_size)
+{
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (cell);
+
+	gint xpad;
+
+	if (!priv->size_from_mask)
+		{
+			GTK_CELL_RENDERER_CLASS (parent_class)->get_preferred_width (cell, widget, minimum_size, natural_size);
+			return;
+		}
+
+	gtk_cell_renderer_masked_update_size (cell, widget);
+	gtk_cell_renderer_get_padding (cell, &xpad, NULL);
+
+	if (minimum_size != NULL)
+		{
+			*minimum_size = priv->size_width + 2 * xpad;
+		}
+	if (natural_size != NULL)
+		{
+			*natural_size = priv->size_width + 2 * xpad;
+		}
+}
+
+static void
+gtk_cell_renderer_masked_get_preferred_height (GtkCellRenderer *cell,
+                                               GtkWidget *widget,
+                                               gint *minimum_size,
+                                               gint *natural_size)
+{
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (cell);
+
+	gint ypad;
+
+	if (!priv->size_from_mask)
+		{
+			GTK_CELL_RENDERER_CLASS (parent_class)->get_preferred_height (cell, widget, minimum_size, natural_size);
+			return;
+		}
+
+	gtk_cell_renderer_masked_update_size (cell, widget);
+	gtk_cell_renderer_get_padding (cell, NULL, &ypad);
+
+	if (minimum_size != NULL)
+		{
+			*minimum_size = priv->size_height + 2 * ypad;
+		}
+	if (natural_size != NULL)
+		{
+			*natural_size = priv->size_height + 2 * ypad;
+		}
+}
+
+static void
+gtk_cell_renderer_masked_get_preferred_height_for_width (GtkCellRenderer *cell,
+                                                         GtkWidget *widget,
+                                                         gint width,
+                                                         gint *minimum_height,
+                                                         gint *natural_height)
+{
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (cell);
+
+	if (!priv->size_from_mask)
+		{
+			GTK_CELL_RENDERER_CLASS (parent_class)->get_preferred_height_for_width (cell, widget, width,
+			                                                                        minimum_height, natural_height);
+			return;
+		}
+
+	gtk_cell_renderer_masked_get_preferred_height (cell, widget, minimum_height, natural_height);
+}
+
+/*
+ * the editors: they are kept once the view is done with them and used again
+ * for the following edits with the same compiled mask
+ */
+static void
+gtk_cell_renderer_masked_editor_drop (GtkCellRendererMasked *renderer,
+                                      GtkWidget *editor)
+{
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (renderer);
+
+	priv->editors = g_slist_remove (priv->editors, editor);
+	g_signal_handlers_disconnect_matched (editor, G_SIGNAL_MATCH_DATA,
+	                                      0, 0, NULL, NULL, renderer);
+	g_object_unref (editor);
+}
+
+static void
+gtk_cell_renderer_masked_row_mask_free (gpointer data)
+{
+	GtkCellRendererMaskedRowMask *row_mask = data;
+
+	mask_core_unref (row_mask->mask);
+	g_free (row_mask);
+}
+
+/* forgets the masks of the rows least recently used, down to keep, with
+ * their idle editors */
+static void
+gtk_cell_renderer_masked_row_masks_trim (GtkCellRendererMasked *renderer,
+                                         guint keep)
+{
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (renderer);
+
+	GtkCellRendererMaskedRowMask *row_mask;
+	gboolean trimmed = FALSE;
+
+	while (priv->row_masks_lru.length > keep)
+		{
+			row_mask = g_queue_pop_tail_link (&priv->row_masks_lru)->data;
+			if (row_mask->mask == priv->row_mask)
+				{
+					priv->row_mask = NULL;
+				}
+			g_hash_table_remove (priv->row_masks, row_mask->mask->text);
+			trimmed = TRUE;
+		}
+
+	if (trimmed)
+		{
+			priv->size_width = -1;
+			gtk_cell_renderer_masked_pool_prune (renderer);
+		}
+}
+
+/* whether mask is the one of the column or of some row */
+static gboolean
+gtk_cell_renderer_masked_mask_in_use (GtkCellRendererMasked *renderer,
+                                      MaskCore *mask)
+{
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (renderer);
+
+	GtkCellRendererMaskedRowMask *row_mask;
+
+	if (mask == priv->mask)
+		{
+			return TRUE;
+		}
+
+	row_mask = g_hash_table_lookup (priv->row_masks, mask->text);
+	return (row_mask != NULL && row_mask->mask == mask);
+}
+
+/* drops the idle editors of the masks no longer used */
+static void
+gtk_cell_renderer_masked_pool_prune (GtkCellRendererMasked *renderer)
+{
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (renderer);
+
+	GHashTableIter iter;
+	gpointer mask, idle;
+
+	g_hash_table_iter_init (&iter, priv->pool);
+	while (g_hash_table_iter_next (&iter, &mask, &idle))
+		{
+			if (gtk_cell_renderer_masked_mask_in_use (renderer, mask))
+				{
+					continue;
+				}
+
+			while (!g_queue_is_empty (idle))
+				{
+					gtk_cell_renderer_masked_editor_drop (renderer, g_queue_pop_head (idle));
+				}
+			g_hash_table_iter_remove (&iter);
+		}
+}
+
+static void
+gtk_cell_renderer_masked_editor_parent_set (GObject *editor,
+                                            GParamSpec *pspec,
+                                            gpointer data)
+{
+	GtkCellRendererMasked *renderer = GTK_CELL_RENDERER_MASKED (data);
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (data);
+
+	MaskCore *mask;
+	GQueue *idle;
+
+	if (gtk_widget_get_parent (GTK_WIDGET (editor)) != NULL)
+		{
+			return;
+		}
+
+	/* removed from the view, or destroyed with it */
+	if (gtk_widget_in_destruction (GTK_WIDGET (editor)))
+		{
+			gtk_cell_renderer_masked_editor_drop (renderer, GTK_WIDGET (editor));
+			return;
+		}
+
+	/* the handlers GtkEntry connects at every edit are replaced by
+	 * GtkMaskedEntry itself, at the next one */
+	g_signal_handlers_disconnect_by_func (editor, gtk_cell_renderer_masked_editing_done, data);
+
+	/* the edit outlived its mask */
+	mask = g_object_get_data (editor, GTK_CELL_RENDERER_MASKED_EDITOR_MASK);
+	if (!gtk_cell_renderer_masked_mask_in_use (renderer, mask))
+		{
+			gtk_cell_renderer_masked_editor_drop (renderer, GTK_WIDGET (editor));
+			return;
+		}
+
+	idle = g_hash_table_lookup (priv->pool, mask);
+	if (idle == NULL)
+		{
+			idle = g_queue_new ();
+			g_hash_table_insert (priv->pool, mask_core_ref (mask), idle);
+		}
+
+	if (idle->length < GTK_CELL_RENDERER_MASKED_POOL_SIZE)
+		{
+			g_queue_push_head (idle, editor);
+		}
+	else
+		{
+			gtk_cell_renderer_masked_editor_drop (renderer, GTK_WIDGET (editor));
+		}
+}
+
+static GtkWidget
+*gtk_cell_renderer_masked_get_editor (GtkCellRendererMasked *renderer,
+                                      MaskCore *mask)
+{
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (renderer);
+
+	GQueue *idle;
+	GtkWidget *editor;
+
+	idle = g_hash_table_lookup (priv->pool, mask);
+	if (idle != NULL && idle->length > 0)
+		{
+			return g_queue_pop_head (idle);
+		}
+
+	editor = g_object_new (GTK_TYPE_MASKED_ENTRY,
+	                       "has-frame", FALSE,
+	                       NULL);
+	g_object_ref_sink (editor);
+	gtk_masked_entry_set_mask (GTK_MASKED_ENTRY (editor), mask->text);
+
+	g_object_set_data_full (G_OBJECT (editor), GTK_CELL_RENDERER_MASKED_EDITOR_MASK,
+	                        mask_core_ref (mask), (GDestroyNotify)mask_core_unref);
+	g_signal_connect (editor, "notify::parent",
+	                  G_CALLBACK (gtk_cell_renderer_masked_editor_parent_set), renderer);
+
+	priv->editors = g_slist_prepend (priv->editors, editor);
+
+	return editor;
 }
 
 static GtkCellEditable
@@ -206,6 +945,7 @@ static GtkCellEditable
 	GtkCellRendererMasked *celltext;
 	GtkCellRendererMaskedPrivate *priv;
 
+	GtkTreeModel *model;
 	gboolean editable;
 	gfloat xalign;
 	gchar *text;
@@ -219,20 +959,28 @@ static GtkCellEditable
 		return NULL;
 
 	g_object_get (G_OBJECT (cell), "xalign", &xalign, NULL);
-	priv->entry = g_object_new (GTK_TYPE_MASKED_ENTRY,
-	                            "has-frame", FALSE,
-	                            "xalign", xalign,
-	                            NULL);
-
-	if (priv->mask)
-		gtk_masked_entry_set_mask (GTK_MASKED_ENTRY (priv->entry), priv->mask);
+	priv->entry = gtk_cell_renderer_masked_get_editor (celltext, GTK_CELL_RENDERER_MASKED_CURRENT_MASK (priv));
+	g_object_set (G_OBJECT (priv->entry),
+	              "xalign", xalign,
+	              "editing-canceled", FALSE,
+	              NULL);
 
 	text = NULL;
 	g_object_get (G_OBJECT (celltext), "text", &text, NULL);
-	if (text)
-		gtk_entry_set_text (GTK_ENTRY (priv->entry), text);
+	gtk_entry_set_text (GTK_ENTRY (priv->entry), text != NULL ? text : "");
+	g_free (text);
 
 	g_object_set_data_full (G_OBJECT (priv->entry), GTK_CELL_RENDERER_TEXT_PATH, g_strdup (path), g_free);
+	model = (GTK_IS_TREE_VIEW (widget) ? gtk_tree_view_get_model (GTK_TREE_VIEW (widget)) : NULL);
+	if (model != NULL)
+		{
+			g_object_set_data_full (G_OBJECT (priv->entry), GTK_CELL_RENDERER_MASKED_EDITOR_MODEL,
+			                        g_object_ref (model), g_object_unref);
+		}
+	else
+		{
+			g_object_set_data (G_OBJECT (priv->entry), GTK_CELL_RENDERER_MASKED_EDITOR_MODEL, NULL);
+		}
 
 	gtk_editable_select_region (GTK_EDITABLE (priv->entry), 0, -1);
 
@@ -260,5 +1008,318 @@ gtk_cell_renderer_masked_set_mask (GtkCellRendererMasked *renderer,
 	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (renderer);
 
 	g_object_set (GTK_CELL_RENDERER_TEXT (renderer), "text", "", NULL);
-	priv->mask = g_strdup (mask);
+	mask_core_unref (priv->mask);
+	priv->mask = mask_core_intern (mask);
+	priv->row_mask = NULL;
+	priv->size_width = -1;
+
+	gtk_cell_renderer_masked_cache_clear (renderer);
+	gtk_cell_renderer_masked_pool_prune (renderer);
+}
+
+/**
+ * gtk_cell_renderer_masked_set_row_mask:
+ * @renderer: a #GtkCellRendererMasked.
+ * @mask: the mask of the row, or %NULL for the mask of the column.
+ *
+ * Sets the mask of the row about to be rendered, as the "row-mask" property
+ * bound to a model column with gtk_tree_view_column_add_attribute() does.
+ * Unlike gtk_cell_renderer_masked_set_mask(), the text and the formatted rows
+ * are kept, and the masks of the last rows stay compiled: going from a row to
+ * another with a different mask is a hash table lookup. They are forgotten
+ * when the model changes.
+ */
+void
+gtk_cell_renderer_masked_set_row_mask (GtkCellRendererMasked *renderer,
+                                       const gchar *mask)
+{
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (renderer);
+
+	GtkCellRendererMaskedRowMask *row_mask;
+
+	if (mask == NULL)
+		{
+			priv->row_mask = NULL;
+			return;
+		}
+	if (priv->row_mask != NULL && strcmp (priv->row_mask->text, mask) == 0)
+		{
+			return;
+		}
+
+	row_mask = g_hash_table_lookup (priv->row_masks, mask);
+	if (row_mask != NULL)
+		{
+			g_queue_unlink (&priv->row_masks_lru, &row_mask->link);
+			g_queue_push_head_link (&priv->row_masks_lru, &row_mask->link);
+		}
+	else
+		{
+			gtk_cell_renderer_masked_row_masks_trim (renderer, GTK_CELL_RENDERER_MASKED_ROW_MASKS - 1);
+
+			row_mask = g_new (GtkCellRendererMaskedRowMask, 1);
+			row_mask->mask = mask_core_intern (mask);
+			row_mask->link.data = row_mask;
+			row_mask->link.prev = NULL;
+			row_mask->link.next = NULL;
+			g_queue_push_head_link (&priv->row_masks_lru, &row_mask->link);
+			g_hash_table_insert (priv->row_masks, row_mask->mask->text, row_mask);
+			priv->size_width = -1;
+		}
+
+	priv->row_mask = row_mask->mask;
+}
+
+/**
+ * gtk_cell_renderer_masked_set_raw_column:
+ * @renderer: a #GtkCellRendererMasked.
+ * @column: the #GtkTreeViewColumn packing @renderer.
+ * @model_column: a column of the model, of type G_TYPE_STRING, with the
+ * values without the mask.
+ *
+ * Shows the values of @model_column formatted with the mask, so that the
+ * model does not have to keep them formatted. The formatted text of the last
+ * rows shown is kept (see the #GtkCellRendererMasked:cache-size property), if
+ * the iters of the model persist; a row is formatted again only when it
+ * changes.
+ *
+ * It sets the cell data function of @renderer in @column.
+ *
+ * With the #GtkCellRendererMasked:write-raw property set, and a #GtkListStore
+ * or #GtkTreeStore as model of the #GtkTreeView edited, the edited values are
+ * written without the mask in @model_column of that model, instead of being given to the handlers of "edited" and
+ * "edited-raw".
+ */
+void
+gtk_cell_renderer_masked_set_raw_column (GtkCellRendererMasked *renderer,
+                                         GtkTreeViewColumn *column,
+                                         gint model_column)
+{
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (renderer);
+
+	g_return_if_fail (GTK_IS_CELL_RENDERER_MASKED (renderer));
+	g_return_if_fail (GTK_IS_TREE_VIEW_COLUMN (column));
+
+	priv->raw_column = model_column;
+	gtk_cell_renderer_masked_cache_clear (renderer);
+
+	gtk_tree_view_column_set_cell_data_func (column, GTK_CELL_RENDERER (renderer),
+	                                         gtk_cell_renderer_masked_raw_data_func,
+	                                         NULL, NULL);
+}
+
+/*
+ * the cache of the formatted rows
+ */
+static guint
+gtk_cell_renderer_masked_iter_hash (gconstpointer key)
+{
+	const GtkTreeIter *iter = key;
+
+	return g_direct_hash (iter->user_data)
+	       ^ (g_direct_hash (iter->user_data2) * 31)
+	       ^ (g_direct_hash (iter->user_data3) * 961);
+}
+
+static gboolean
+gtk_cell_renderer_masked_iter_equal (gconstpointer a, gconstpointer b)
+{
+	const GtkTreeIter *iter_a = a;
+	const GtkTreeIter *iter_b = b;
+
+	return iter_a->user_data == iter_b->user_data
+	       && iter_a->user_data2 == iter_b->user_data2
+	       && iter_a->user_data3 == iter_b->user_data3;
+}
+
+static void
+gtk_cell_renderer_masked_cache_remove (GtkCellRendererMasked *renderer,
+                                       GtkCellRendererMaskedCached *cached)
+{
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (renderer);
+
+	g_hash_table_remove (priv->cache, &cached->iter);
+	g_queue_unlink (&priv->cache_lru, &cached->link);
+	g_free (cached);
+}
+
+static void
+gtk_cell_renderer_masked_cache_clear (GtkCellRendererMasked *renderer)
+{
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (renderer);
+
+	while (priv->cache_lru.head != NULL)
+		{
+			gtk_cell_renderer_masked_cache_remove (renderer, priv->cache_lru.head->data);
+		}
+}
+
+static void
+gtk_cell_renderer_masked_cache_row_changed (GtkTreeModel *model,
+                                            GtkTreePath *path,
+                                            GtkTreeIter *iter,
+                                            gpointer data)
+{
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (data);
+
+	GtkCellRendererMaskedCached *cached;
+
+	/* also for inserted rows, that can take the iter of a deleted one */
+	cached = g_hash_table_lookup (priv->cache, iter);
+	if (cached != NULL)
+		{
+			gtk_cell_renderer_masked_cache_remove (GTK_CELL_RENDERER_MASKED (data), cached);
+		}
+}
+
+static void
+gtk_cell_renderer_masked_cache_row_deleted (GtkTreeModel *model,
+                                            GtkTreePath *path,
+                                            gpointer data)
+{
+	/* the iter of the row is gone: it cannot be told apart */
+	gtk_cell_renderer_masked_cache_clear (GTK_CELL_RENDERER_MASKED (data));
+}
+
+static void
+gtk_cell_renderer_masked_cache_set_model (GtkCellRendererMasked *renderer,
+                                          GtkTreeModel *model)
+{
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (renderer);
+
+	gtk_cell_renderer_masked_cache_clear (renderer);
+
+	/* the masks of the rows of the old model, but the one of the row
+	 * being rendered, which is the most recent */
+	gtk_cell_renderer_masked_row_masks_trim (renderer, priv->row_mask != NULL ? 1 : 0);
+
+	if (priv->cache_model != NULL)
+		{
+			g_signal_handlers_disconnect_matched (priv->cache_model, G_SIGNAL_MATCH_DATA,
+			                                      0, 0, NULL, NULL, renderer);
+			g_object_unref (priv->cache_model);
+			priv->cache_model = NULL;
+		}
+
+	if (model != NULL)
+		{
+			priv->cache_model = g_object_ref (model);
+			g_signal_connect (model, "row-changed",
+			                  G_CALLBACK (gtk_cell_renderer_masked_cache_row_changed), renderer);
+			g_signal_connect (model, "row-inserted",
+			                  G_CALLBACK (gtk_cell_renderer_masked_cache_row_changed), renderer);
+			g_signal_connect (model, "row-deleted",
+			                  G_CALLBACK (gtk_cell_renderer_masked_cache_row_deleted), renderer);
+		}
+
+	if (priv->cache == NULL)
+		{
+			priv->cache = g_hash_table_new (gtk_cell_renderer_masked_iter_hash,
+			                                gtk_cell_renderer_masked_iter_equal);
+		}
+}
+
+static void
+gtk_cell_renderer_masked_raw_data_func (GtkTreeViewColumn *column,
+                                        GtkCellRenderer *cell,
+                                        GtkTreeModel *model,
+                                        GtkTreeIter *iter,
+                                        gpointer data)
+{
+	GtkCellRendererMasked *renderer = GTK_CELL_RENDERER_MASKED (cell);
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (cell);
+
+	GtkCellRendererMaskedCached *cached;
+	MaskCore *mask;
+	gchar *raw;
+	gboolean persist;
+
+	if (model != priv->cache_model)
+		{
+			gtk_cell_renderer_masked_cache_set_model (renderer, model);
+		}
+	if (iter->stamp != priv->cache_stamp)
+		{
+			gtk_cell_renderer_masked_cache_clear (renderer);
+			priv->cache_stamp = iter->stamp;
+		}
+
+	persist = (priv->cache_size > 0
+	           && (gtk_tree_model_get_flags (model) & GTK_TREE_MODEL_ITERS_PERSIST) != 0);
+
+	cached = (persist ? g_hash_table_lookup (priv->cache, iter) : NULL);
+	if (cached != NULL)
+		{
+			g_queue_unlink (&priv->cache_lru, &cached->link);
+			g_queue_push_head_link (&priv->cache_lru, &cached->link);
+
+			g_object_set (cell, "text", cached->text, NULL);
+			return;
+		}
+
+	raw = NULL;
+	gtk_tree_model_get (model, iter, priv->raw_column, &raw, -1);
+
+	mask = GTK_CELL_RENDERER_MASKED_CURRENT_MASK (priv);
+	cached = g_malloc (sizeof (GtkCellRendererMaskedCached) + mask->length);
+	cached->iter = *iter;
+	cached->link.data = cached;
+	cached->link.prev = NULL;
+	cached->link.next = NULL;
+	if (raw == NULL || raw[0] == '\0')
+		{
+			cached->text[0] = '\0';
+		}
+	else
+		{
+			mask_core_format (mask, raw, -1, cached->text);
+		}
+	g_free (raw);
+
+	g_object_set (cell, "text", cached->text, NULL);
+
+	if (!persist)
+		{
+			g_free (cached);
+			return;
+		}
+
+	if (priv->cache_lru.length >= priv->cache_size)
+		{
+			gtk_cell_renderer_masked_cache_remove (renderer, priv->cache_lru.tail->data);
+		}
+	g_hash_table_insert (priv->cache, &cached->iter, cached);
+	g_queue_push_head_link (&priv->cache_lru, &cached->link);
+}
+
+static void
+gtk_cell_renderer_masked_finalize (GObject *object)
+{
+	GtkCellRendererMaskedPrivate *priv = GTK_CELL_RENDERER_MASKED_GET_PRIVATE (object);
+
+	gtk_cell_renderer_masked_cache_set_model (GTK_CELL_RENDERER_MASKED (object), NULL);
+	g_hash_table_destroy (priv->cache);
+	priv->cache = NULL;
+
+	/* an editor still in a view stays there, without the renderer */
+	g_hash_table_destroy (priv->pool);
+	priv->pool = NULL;
+	priv->row_mask = NULL;
+	g_hash_table_destroy (priv->row_masks);
+	priv->row_masks = NULL;
+	while (priv->editors != NULL)
+		{
+			gtk_cell_renderer_masked_editor_drop (GTK_CELL_RENDERER_MASKED (object), priv->editors->data);
+		}
+
+	mask_core_unref (priv->mask);
+	priv->mask = NULL;
+
+	if (priv->size_font != NULL)
+		{
+			pango_font_description_free (priv->size_font);
+			priv->size_font = NULL;
+		}
+
+	G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -47,6 +47,17 @@ struct _GtkCellRendererMasked
 struct _GtkCellRendererMaskedClass
 {
   GtkCellRendererTextClass parent_class;
+
+  void (*edited_raw) (GtkCellRendererMasked *renderer,
+                      const gchar *path,
+                      const gchar *raw_text);
+
+  /* padding for signals added later, without changing the size of the
+   * class */
+  void (*_gtk_cell_renderer_masked_reserved1) (void);
+  void (*_gtk_cell_renderer_masked_reserved2) (void);
+  void (*_gtk_cell_renderer_masked_reserved3) (void);
+  void (*_gtk_cell_renderer_masked_reserved4) (void);
 };
 
 
@@ -56,6 +67,11 @@ GtkCellRenderer *gtk_cell_renderer_masked_new (void);
 GtkCellRenderer *gtk_cell_renderer_masked_new_with_mask (const gchar *mask);
 
 void gtk_cell_renderer_masked_set_mask (GtkCellRendererMasked *renderer, const gchar *mask);
+void gtk_cell_renderer_masked_set_row_mask (GtkCellRendererMasked *renderer, const gchar *mask);
+
+void gtk_cell_renderer_masked_set_raw_column (GtkCellRendererMasked *renderer,
+                                              GtkTreeViewColumn *column,
+                                              gint model_column);
 
 
 G_END_DECLS
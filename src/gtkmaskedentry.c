@@ -22,11 +22,12 @@
 	#include "config.h"
 #endif
 
-#include <ctype.h>
 #include <string.h>
 
 #include <gdk/gdkkeysyms.h>
 
+#include "maskcore.h"
+#include "gtkmaskedentrybuffer.h"
 #include "gtkmaskedentry.h"
 
 typedef enum
@@ -39,34 +40,62 @@ enum
 {
 	PROP_0,
 	PROP_MASK,
-	PROP_TAB_INSIDE
+	PROP_TAB_INSIDE,
+	PROP_RAW_TEXT,
+	PROP_BURST_INTERVAL,
+	PROP_VALID,
+	PROP_IS_COMPLETE,
+	PROP_FILLED_COUNT
 };
 
+enum
+{
+	SCAN_COMPLETE,
+	LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL] = { 0 };
+
 static void gtk_masked_entry_class_init (GtkMaskedEntryClass *klass);
 static void gtk_masked_entry_init (GtkMaskedEntry *masked_entry);
+static void gtk_masked_entry_editable_init (GtkEditableInterface *iface);
+static void gtk_masked_entry_cell_editable_init (GtkCellEditableIface *iface);
 
 static gboolean gtk_masked_entry_key_press_event (GtkWidget   *widget,
-                                                  GdkEventKey *event,
-                                                  gpointer     user_data);
+                                                  GdkEventKey *event);
+static gboolean gtk_masked_entry_focus_out_event (GtkWidget     *widget,
+                                                  GdkEventFocus *event);
+static void gtk_masked_entry_start_editing (GtkCellEditable *cell_editable,
+                                            GdkEvent *event);
 static void gtk_masked_entry_delete_text      (GtkEditable *editable,
                                                gint         start_pos,
-                                               gint         end_pos,
-                                               gpointer     user_data);
+                                               gint         end_pos);
 static void gtk_masked_entry_insert_text      (GtkEditable *editable,
                                                const gchar *text,
                                                gint         length,
-                                               gint        *position,
-                                               gpointer     user_data);
-
-static gboolean gtk_masked_entry_is_writeable (gchar c);
-static gint gtk_masked_entry_get_first_writeable_mask (GtkMaskedEntry *masked_entry,
-                                                       GtkMaskedEntryDirections direction);
+                                               gint        *position);
+
+static void gtk_masked_entry_switch_mask (GtkMaskedEntry *masked_entry,
+                                          MaskCore *mask,
+                                          gboolean keep_slots);
+static void gtk_masked_entry_dispatch (GtkMaskedEntry *masked_entry,
+                                       gint *position);
+static void gtk_masked_entry_replace (GtkMaskedEntry *masked_entry,
+                                      gint position,
+                                      const gchar *newtext,
+                                      gint length);
 static gint gtk_masked_entry_get_next_writeable_block (GtkMaskedEntry *masked_entry,
                                                        GtkMaskedEntryDirections direction);
-static void gtk_masked_entry_get_block_positions (GtkMaskedEntry *masked_entry,
-                                                  gint *start,
-                                                  gint *end);
 
+static void gtk_masked_entry_burst_collect (GtkMaskedEntry *masked_entry,
+                                            const gchar *text,
+                                            gint length);
+static void gtk_masked_entry_burst_flush (GtkMaskedEntry *masked_entry);
+static gboolean gtk_masked_entry_burst_timeout (gpointer data);
+
+static void gtk_masked_entry_notify (GObject *object,
+                                     GParamSpec *pspec);
+static void gtk_masked_entry_finalize (GObject *object);
 static void gtk_masked_entry_set_property (GObject *object,
                                            guint property_id,
                                            const GValue *value,
@@ -81,21 +110,63 @@ static void gtk_masked_entry_get_property (GObject *object,
 typedef struct _GtkMaskedEntryPrivate GtkMaskedEntryPrivate;
 struct _GtkMaskedEntryPrivate
 	{
-		gchar *mask;
+		MaskCore *mask;
 		gboolean tab_inside;
+
+		/* the alternative masks, by prefix of the value, or NULL */
+		MaskCoreSet *masks;
+
+		/* scratch buffer for the text to insert, sized from the mask so
+		 * that a keystroke never allocates */
+		gchar *newtext;
+
+		/* the value without the mask, when the buffer is not a
+		 * GtkMaskedEntryBuffer */
+		gchar *raw;
+
+		/* the characters typed within burst_interval milliseconds of each
+		 * other, inserted at once when the keys stop or another key comes;
+		 * burst_typing is set while a key goes through the input method */
+		guint burst_interval;
+		GString *burst;
+		guint burst_keys;
+		gint64 burst_last;
+		guint burst_source;
+		gboolean burst_typing;
+
+		/* the last "valid", "is-complete" and "filled-count" notified */
+		gboolean valid;
+		gboolean complete;
+		gint filled_count;
+
+		/* the "activate" and "key-press-event" handlers GtkEntry connects
+		 * at every gtk_cell_editable_start_editing() */
+		gulong cell_handlers[2];
 	};
 
-G_DEFINE_TYPE (GtkMaskedEntry, gtk_masked_entry, GTK_TYPE_ENTRY)
+static GtkCellEditableIface *parent_cell_editable_iface;
+
+G_DEFINE_TYPE_WITH_CODE (GtkMaskedEntry, gtk_masked_entry, GTK_TYPE_ENTRY,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_EDITABLE,
+                                                gtk_masked_entry_editable_init)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_CELL_EDITABLE,
+                                                gtk_masked_entry_cell_editable_init))
 
 static void
 gtk_masked_entry_class_init (GtkMaskedEntryClass *klass)
 {
 	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
 
 	g_type_class_add_private (object_class, sizeof (GtkMaskedEntryPrivate));
 
 	object_class->set_property = gtk_masked_entry_set_property;
 	object_class->get_property = gtk_masked_entry_get_property;
+	object_class->notify = gtk_masked_entry_notify;
+	object_class->finalize = gtk_masked_entry_finalize;
+
+	widget_class->key_press_event = gtk_masked_entry_key_press_event;
+	widget_class->focus_out_event = gtk_masked_entry_focus_out_event;
 
 	g_object_class_install_property (object_class, PROP_MASK,
 	                                 g_param_spec_string ("mask",
@@ -109,6 +180,53 @@ gtk_masked_entry_class_init (GtkMaskedEntryClass *klass)
 	                                                       "Whether pressing tab moves between mask's parts or outside the widget",
 	                                                       FALSE,
 	                                                       G_PARAM_READWRITE));
+	g_object_class_install_property (object_class, PROP_RAW_TEXT,
+	                                 g_param_spec_string ("raw-text",
+	                                                      "The text without the mask",
+	                                                      "The characters of the writeable positions filled, in order",
+	                                                      "",
+	                                                      G_PARAM_READWRITE));
+	g_object_class_install_property (object_class, PROP_BURST_INTERVAL,
+	                                 g_param_spec_uint ("burst-interval",
+	                                                    "Burst interval",
+	                                                    "The milliseconds within which the characters typed are inserted together, as a barcode scanner types them; 0 inserts every character when typed",
+	                                                    0, G_MAXUINT, 0,
+	                                                    G_PARAM_READWRITE));
+	g_object_class_install_property (object_class, PROP_VALID,
+	                                 g_param_spec_boolean ("valid",
+	                                                       "Valid",
+	                                                       "Whether all the writeable positions are filled and the check digits of the mask are right",
+	                                                       TRUE,
+	                                                       G_PARAM_READABLE));
+	g_object_class_install_property (object_class, PROP_IS_COMPLETE,
+	                                 g_param_spec_boolean ("is-complete",
+	                                                       "Is complete",
+	                                                       "Whether all the writeable positions are filled",
+	                                                       TRUE,
+	                                                       G_PARAM_READABLE));
+	g_object_class_install_property (object_class, PROP_FILLED_COUNT,
+	                                 g_param_spec_int ("filled-count",
+	                                                   "Filled count",
+	                                                   "The number of writeable positions filled",
+	                                                   0, G_MAXINT, 0,
+	                                                   G_PARAM_READABLE));
+
+	/**
+	 * GtkMaskedEntry::scan-complete:
+	 * @masked_entry: the object which received the signal.
+	 *
+	 * Emitted, after #GtkEditable::changed, when more than one character
+	 * typed within #GtkMaskedEntry:burst-interval milliseconds of each other
+	 * have been inserted, as a barcode scanner types them.
+	 */
+	signals[SCAN_COMPLETE] =
+		g_signal_new ("scan-complete",
+		              G_OBJECT_CLASS_TYPE (object_class),
+		              G_SIGNAL_RUN_LAST,
+		              G_STRUCT_OFFSET (GtkMaskedEntryClass, scan_complete),
+		              NULL, NULL,
+		              g_cclosure_marshal_VOID__VOID,
+		              G_TYPE_NONE, 0);
 }
 
 static void
@@ -116,19 +234,47 @@ gtk_masked_entry_init (GtkMaskedEntry *masked_entry)
 {
 	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
 
-	priv->mask = g_strdup ("");
+	GtkEntryBuffer *buffer;
+
+	priv->mask = mask_core_intern ("");
 	priv->tab_inside = FALSE;
+	priv->masks = NULL;
+	priv->newtext = g_new (gchar, 1);
+	priv->raw = g_new0 (gchar, 1);
+	priv->burst_interval = 0;
+	priv->burst = g_string_sized_new (64);
+	priv->burst_keys = 0;
+	priv->burst_last = 0;
+	priv->burst_source = 0;
+	priv->burst_typing = FALSE;
+	priv->valid = TRUE;
+	priv->complete = TRUE;
+	priv->filled_count = 0;
+	priv->cell_handlers[0] = 0;
+	priv->cell_handlers[1] = 0;
+
+	buffer = gtk_masked_entry_buffer_new (priv->mask);
+	gtk_entry_set_buffer (GTK_ENTRY (masked_entry), buffer);
+	g_object_unref (buffer);
 
-	g_signal_connect (G_OBJECT (masked_entry), "key-press-event",
-	                  G_CALLBACK (gtk_masked_entry_key_press_event), (gpointer)masked_entry);
+	gtk_widget_set_events ((GtkWidget *)masked_entry, GDK_KEY_PRESS_MASK);
+}
 
-	g_signal_connect (G_OBJECT (masked_entry), "delete-text",
-	                  G_CALLBACK (gtk_masked_entry_delete_text), (gpointer)masked_entry);
+/* the default handlers of "insert-text" and "delete-text" are replaced, so
+ * that the mask is applied without any handler on the instance */
+static void
+gtk_masked_entry_editable_init (GtkEditableInterface *iface)
+{
+	iface->insert_text = gtk_masked_entry_insert_text;
+	iface->delete_text = gtk_masked_entry_delete_text;
+}
 
-	g_signal_connect (G_OBJECT (masked_entry), "insert-text",
-	                  G_CALLBACK (gtk_masked_entry_insert_text), (gpointer)masked_entry);
+static void
+gtk_masked_entry_cell_editable_init (GtkCellEditableIface *iface)
+{
+	parent_cell_editable_iface = g_type_interface_peek_parent (iface);
 
-	gtk_widget_set_events ((GtkWidget *)masked_entry, GDK_KEY_PRESS_MASK);
+	iface->start_editing = gtk_masked_entry_start_editing;
 }
 
 /**
@@ -159,6 +305,9 @@ gtk_masked_entry_new ()
  *   '@': alpha
  *   '^': alpha converted to upper case
  *   '#': alphanumeric
+ * Other classes can be added with mask_core_register_class(). The mask can
+ * end with the check digits of the value, as "0000 0000 0000 0000{luhn}",
+ * see #MaskCoreChecksum and the #GtkMaskedEntry:valid property.
  *
  * Returns: the newly created #GtkMaskedEntry widget.
  */
@@ -178,6 +327,9 @@ gtk_masked_entry_new_with_mask (const gchar *mask)
  * @mask: the mask (see gtk_masked_entry_new_with_mask() for explanation).
  *
  * Set the mask. View gtk_masked_entry_new_with_mask() for possible values.
+ * The contents without the mask are kept, formatted with the new mask as far
+ * as it accepts them. With alternative masks, see gtk_masked_entry_add_mask(),
+ * @mask is the one of the values no prefix matches.
  */
 void
 gtk_masked_entry_set_mask (GtkMaskedEntry *masked_entry,
@@ -185,22 +337,48 @@ gtk_masked_entry_set_mask (GtkMaskedEntry *masked_entry,
 {
 	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
 
-	gint l = 0;
-
-	if (mask != NULL && (l = strlen (mask)) != 0)
+	if (priv->masks != NULL)
 		{
-			priv->mask = g_strdup (mask);
+			mask_core_set_add (priv->masks, "", mask);
+			gtk_masked_entry_dispatch (masked_entry, NULL);
 		}
 	else
 		{
-			priv->mask = g_strdup ("");
+			gtk_masked_entry_switch_mask (masked_entry, mask_core_intern (mask), FALSE);
 		}
+}
 
-	gtk_entry_set_max_length (GTK_ENTRY (masked_entry), l);
+/**
+ * gtk_masked_entry_add_mask:
+ * @masked_entry: a #GtkMaskedEntry.
+ * @prefix: the first characters of the values, without the mask, taking
+ * @mask.
+ * @mask: the mask (see gtk_masked_entry_new_with_mask() for explanation).
+ *
+ * Adds an alternative mask, as card numbers or IBANs need: while the value
+ * typed starts with @prefix, the mask is @mask, switched to without
+ * clearing the value. The longest prefix matching wins; the values no
+ * prefix matches take the mask set with gtk_masked_entry_set_mask().
+ * Choosing the mask at every change costs a lookup for each character of
+ * the longest prefix, however many masks are added.
+ */
+void
+gtk_masked_entry_add_mask (GtkMaskedEntry *masked_entry,
+                           const gchar    *prefix,
+                           const gchar    *mask)
+{
+	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
 
-	g_signal_emit_by_name (G_OBJECT (masked_entry), "delete-text",
-	                       0, l,
-	                       (gpointer)masked_entry);
+	g_return_if_fail (GTK_IS_MASKED_ENTRY (masked_entry));
+
+	if (priv->masks == NULL)
+		{
+			priv->masks = mask_core_set_new ();
+			mask_core_set_add (priv->masks, "", priv->mask->text);
+		}
+	mask_core_set_add (priv->masks, prefix, mask);
+
+	gtk_masked_entry_dispatch (masked_entry, NULL);
 }
 
 /**
@@ -214,54 +392,267 @@ gtk_masked_entry_get_mask (GtkMaskedEntry *masked_entry)
 {
 	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
 
-	return g_strdup (priv->mask);
+	return priv->mask->text;
 }
 
 /**
  * gtk_masked_entry_get_text:
  * @masked_entry: a #GtkMaskedEntry.
  *
- * Returns: a pointer to the contents of the widget as a string without 
- * the mask.
+ * Returns: the contents of the widget as a string without the mask. It is
+ * owned by the widget and valid until its next change; see also the
+ * #GtkMaskedEntry:raw-text property.
  */
 G_CONST_RETURN gchar*
 gtk_masked_entry_get_text (GtkMaskedEntry *masked_entry)
 {
-	G_CONST_RETURN gchar *text, *mask;
-	gchar *ret;
-	gint i, c = 0, lmask;
+	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
+	GtkEntryBuffer *buffer = gtk_entry_get_buffer (GTK_ENTRY (masked_entry));
+
+	if (GTK_IS_MASKED_ENTRY_BUFFER (buffer))
+		{
+			/* kept up to date by the buffer, no need to parse the text */
+			return gtk_masked_entry_buffer_get_raw_text (GTK_MASKED_ENTRY_BUFFER (buffer));
+		}
+
+	mask_core_unformat (priv->mask, gtk_entry_get_text (GTK_ENTRY (masked_entry)), -1, priv->raw);
+
+	return priv->raw;
+}
+
+/**
+ * gtk_masked_entry_get_filled_count:
+ * @masked_entry: a #GtkMaskedEntry.
+ *
+ * Gets the number of writeable positions filled. It is counted as the value
+ * changes, so that the completeness of a form is a sum of integers; see
+ * also the #GtkMaskedEntry:filled-count property.
+ *
+ * Returns: the number of writeable positions filled.
+ */
+gint
+gtk_masked_entry_get_filled_count (GtkMaskedEntry *masked_entry)
+{
+	GtkEntryBuffer *buffer = gtk_entry_get_buffer (GTK_ENTRY (masked_entry));
 
-	text = gtk_entry_get_text (GTK_ENTRY (masked_entry));
-	mask = gtk_masked_entry_get_mask (masked_entry);
-	lmask = strlen (mask);
+	g_return_val_if_fail (GTK_IS_MASKED_ENTRY (masked_entry), 0);
 
-	ret = g_new (gchar, lmask);
-	for (i = 0; i < lmask; i++)
+	if (GTK_IS_MASKED_ENTRY_BUFFER (buffer))
 		{
-			if (gtk_masked_entry_is_writeable (mask[i]))
-				{
-					if (text[i] != '_')
-						{
-							ret[c++] = text[i];
-						}
-				}
+			return gtk_masked_entry_buffer_get_raw_length (GTK_MASKED_ENTRY_BUFFER (buffer));
+		}
+
+	return strlen (gtk_masked_entry_get_text (masked_entry));
+}
+
+/**
+ * gtk_masked_entry_is_complete:
+ * @masked_entry: a #GtkMaskedEntry.
+ *
+ * Returns: whether all the writeable positions of the mask are filled; see
+ * also the #GtkMaskedEntry:is-complete property.
+ */
+gboolean
+gtk_masked_entry_is_complete (GtkMaskedEntry *masked_entry)
+{
+	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
+
+	g_return_val_if_fail (GTK_IS_MASKED_ENTRY (masked_entry), FALSE);
+
+	return gtk_masked_entry_get_filled_count (masked_entry) == priv->mask->n_writeable;
+}
+
+/**
+ * gtk_masked_entry_get_valid:
+ * @masked_entry: a #GtkMaskedEntry.
+ *
+ * Tells whether the value fills all the writeable positions of the mask
+ * and has the check digits it declares right, see mask_core_compile(). It
+ * is kept as the value changes, rather than checking the whole value; see
+ * also the #GtkMaskedEntry:valid property.
+ *
+ * Returns: whether the value is complete and valid.
+ */
+gboolean
+gtk_masked_entry_get_valid (GtkMaskedEntry *masked_entry)
+{
+	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
+	GtkEntryBuffer *buffer = gtk_entry_get_buffer (GTK_ENTRY (masked_entry));
+
+	g_return_val_if_fail (GTK_IS_MASKED_ENTRY (masked_entry), FALSE);
+
+	if (GTK_IS_MASKED_ENTRY_BUFFER (buffer))
+		{
+			return gtk_masked_entry_buffer_get_valid (GTK_MASKED_ENTRY_BUFFER (buffer));
+		}
+
+	return mask_core_check (priv->mask, gtk_masked_entry_get_text (masked_entry), -1);
+}
+
+/**
+ * gtk_masked_entry_set_text:
+ * @masked_entry: a #GtkMaskedEntry.
+ * @text: the contents without the mask.
+ *
+ * Sets the contents of the widget from a value without the mask, as one
+ * change.
+ */
+void
+gtk_masked_entry_set_text (GtkMaskedEntry *masked_entry,
+                           const gchar    *text)
+{
+	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
+	GtkEntryBuffer *buffer = gtk_entry_get_buffer (GTK_ENTRY (masked_entry));
+
+	if (text == NULL)
+		{
+			text = "";
+		}
+
+	/* the mask of the new value first, so that it is formatted with it; the
+	 * buffer notifies once, so that "changed" is emitted once */
+	g_object_freeze_notify (G_OBJECT (buffer));
+	if (priv->masks != NULL)
+		{
+			gtk_masked_entry_switch_mask (masked_entry,
+			                              mask_core_ref (mask_core_set_lookup (priv->masks, text, -1)),
+			                              FALSE);
+		}
+
+	if (GTK_IS_MASKED_ENTRY_BUFFER (buffer))
+		{
+			gtk_masked_entry_buffer_set_raw_text (GTK_MASKED_ENTRY_BUFFER (buffer), text, -1);
+		}
+	else
+		{
+			mask_core_format (priv->mask, text, -1, priv->newtext);
+			gtk_masked_entry_replace (masked_entry, 0, priv->newtext, priv->mask->length);
+		}
+	g_object_thaw_notify (G_OBJECT (buffer));
+}
+
+/*
+ * the bursts of keys: one insertion, one "changed" and one "scan-complete"
+ * for all the characters of a barcode
+ */
+static void
+gtk_masked_entry_burst_flush (GtkMaskedEntry *masked_entry)
+{
+	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
+	GtkEditable *editable = GTK_EDITABLE (masked_entry);
+
+	guint keys;
+	gint pos;
+
+	if (priv->burst_source != 0)
+		{
+			g_source_remove (priv->burst_source);
+			priv->burst_source = 0;
+		}
+	if (priv->burst->len == 0)
+		{
+			return;
+		}
+
+	if (gtk_editable_get_selection_bounds (editable, NULL, NULL))
+		{
+			gtk_editable_delete_selection (editable);
 		}
-	ret[c] = '\0';
 
-	return ret;
+	pos = gtk_editable_get_position (editable);
+	gtk_editable_insert_text (editable, priv->burst->str, priv->burst->len, &pos);
+	gtk_editable_set_position (editable, pos);
+
+	keys = priv->burst_keys;
+	g_string_truncate (priv->burst, 0);
+	priv->burst_keys = 0;
+
+	if (keys > 1)
+		{
+			g_signal_emit (masked_entry, signals[SCAN_COMPLETE], 0);
+		}
 }
 
 /*
- * callbacks
+ * a character typed: held, with the ones following it within burst_interval,
+ * until the keys stop, so that a scan is one edit
+ */
+static void
+gtk_masked_entry_burst_collect (GtkMaskedEntry *masked_entry,
+                                const gchar *text,
+                                gint length)
+{
+	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
+
+	g_string_append_len (priv->burst, text, length);
+	priv->burst_keys++;
+	priv->burst_last = g_get_monotonic_time ();
+	if (priv->burst_source == 0)
+		{
+			priv->burst_source = g_timeout_add (priv->burst_interval,
+			                                    gtk_masked_entry_burst_timeout,
+			                                    masked_entry);
+		}
+}
+
+static gboolean
+gtk_masked_entry_burst_timeout (gpointer data)
+{
+	GtkMaskedEntry *masked_entry = GTK_MASKED_ENTRY (data);
+	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
+
+	gint64 quiet;
+
+	/* waited again from the last key, rather than moving the timeout at
+	 * every key */
+	quiet = (g_get_monotonic_time () - priv->burst_last) / 1000;
+	if (quiet < priv->burst_interval)
+		{
+			priv->burst_source = g_timeout_add (priv->burst_interval - quiet,
+			                                    gtk_masked_entry_burst_timeout,
+			                                    masked_entry);
+			return FALSE;
+		}
+
+	priv->burst_source = 0;
+	gtk_masked_entry_burst_flush (masked_entry);
+
+	return FALSE;
+}
+
+/*
+ * class handlers
  */
 static gboolean
 gtk_masked_entry_key_press_event (GtkWidget   *widget,
-                                  GdkEventKey *event,
-                                  gpointer     user_data)
+                                  GdkEventKey *event)
 {
-	GtkMaskedEntry *masked_entry = GTK_MASKED_ENTRY (user_data);
+	GtkMaskedEntry *masked_entry = GTK_MASKED_ENTRY (widget);
 	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
 
+	gboolean handled;
+
+	if (priv->burst_interval > 0 && gtk_editable_get_editable (GTK_EDITABLE (widget)))
+		{
+			gunichar c = gdk_keyval_to_unicode (event->keyval);
+
+			if (c != 0 && g_unichar_isprint (c)
+			    && (event->state & (GDK_CONTROL_MASK | GDK_MOD1_MASK)) == 0)
+				{
+					/* the text goes through the input method as usual, and is
+					 * held by gtk_masked_entry_insert_text() */
+					priv->burst_typing = TRUE;
+					handled = GTK_WIDGET_CLASS (gtk_masked_entry_parent_class)->key_press_event (widget, event);
+					priv->burst_typing = FALSE;
+
+					return handled;
+				}
+
+			/* any other key, as the terminator of a scanner, comes after the
+			 * characters before it */
+			gtk_masked_entry_burst_flush (masked_entry);
+		}
+
 	if ((event->keyval == GDK_KEY_Tab || event->keyval == GDK_KEY_ISO_Left_Tab)
 		&& priv->tab_inside)
 		{
@@ -284,271 +675,415 @@ gtk_masked_entry_key_press_event (GtkWidget   *widget,
 					gtk_editable_set_position (GTK_EDITABLE (masked_entry), pos);
 					return TRUE;
 				}
-			else
+		}
+
+	return GTK_WIDGET_CLASS (gtk_masked_entry_parent_class)->key_press_event (widget, event);
+}
+
+static gboolean
+gtk_masked_entry_focus_out_event (GtkWidget     *widget,
+                                  GdkEventFocus *event)
+{
+	gtk_masked_entry_burst_flush (GTK_MASKED_ENTRY (widget));
+
+	return GTK_WIDGET_CLASS (gtk_masked_entry_parent_class)->focus_out_event (widget, event);
+}
+
+/* an entry can be edited in cells again and again, as the editors of
+ * GtkCellRendererMasked are: GtkEntry connects its handlers every time, and
+ * only the ones of the last edit are kept; the others connected to the
+ * entry are not touched */
+static void
+gtk_masked_entry_start_editing (GtkCellEditable *cell_editable,
+                                GdkEvent *event)
+{
+	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (cell_editable);
+
+	guint signal_ids[2];
+	GArray *blocked;
+	gulong id;
+	guint i;
+
+	signal_ids[0] = g_signal_lookup ("activate", GTK_TYPE_ENTRY);
+	signal_ids[1] = g_signal_lookup ("key-press-event", GTK_TYPE_WIDGET);
+
+	/* the handlers there before are blocked, so that the ones GtkEntry
+	 * connects are the only ones left unblocked */
+	blocked = g_array_new (FALSE, FALSE, sizeof (gulong));
+	for (i = 0; i < G_N_ELEMENTS (signal_ids); i++)
+		{
+			if (priv->cell_handlers[i] != 0
+			    && g_signal_handler_is_connected (cell_editable, priv->cell_handlers[i]))
+				{
+					g_signal_handler_disconnect (cell_editable, priv->cell_handlers[i]);
+				}
+			priv->cell_handlers[i] = 0;
+
+			while ((id = g_signal_handler_find (cell_editable,
+			                                    G_SIGNAL_MATCH_ID | G_SIGNAL_MATCH_UNBLOCKED,
+			                                    signal_ids[i], 0, NULL, NULL, NULL)) != 0)
 				{
-					return FALSE;
+					g_signal_handler_block (cell_editable, id);
+					g_array_append_val (blocked, id);
 				}
 		}
-	else
+
+	parent_cell_editable_iface->start_editing (cell_editable, event);
+
+	for (i = 0; i < G_N_ELEMENTS (signal_ids); i++)
 		{
-			return FALSE;
+			priv->cell_handlers[i] = g_signal_handler_find (cell_editable,
+			                                                G_SIGNAL_MATCH_ID | G_SIGNAL_MATCH_UNBLOCKED,
+			                                                signal_ids[i], 0, NULL, NULL, NULL);
+		}
+	for (i = 0; i < blocked->len; i++)
+		{
+			g_signal_handler_unblock (cell_editable, g_array_index (blocked, gulong, i));
 		}
+	g_array_free (blocked, TRUE);
 }
 
 static void
 gtk_masked_entry_delete_text (GtkEditable *editable,
                               gint         start_pos,
-                              gint         end_pos,
-                              gpointer     user_data)
+                              gint         end_pos)
 {
-	GtkMaskedEntry *masked_entry = GTK_MASKED_ENTRY (user_data);
+	GtkMaskedEntry *masked_entry = GTK_MASKED_ENTRY (editable);
+	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
+	MaskCore *mask = priv->mask;
 
-	G_CONST_RETURN gchar *mask;
-	gchar *newtext;
-	gint i, c;
+	GtkEntryBuffer *buffer;
+	const gchar *newtext;
+	gint cursor;
 
-	if (start_pos < 0 || end_pos > gtk_entry_get_max_length (GTK_ENTRY (masked_entry)))
+	newtext = mask_core_erase (mask, &start_pos, &end_pos);
+	if (newtext == NULL)
 		{
-			g_signal_stop_emission_by_name (editable, "delete-text");
 			return;
 		}
 
-	newtext = g_new (gchar, end_pos - start_pos + 1);
-	mask = gtk_masked_entry_get_mask (masked_entry);
+	cursor = gtk_editable_get_position (editable);
 
-	for (i = start_pos, c = 0; i < end_pos; i++, c++)
+	/* the deleted part is replaced by the empty mask */
+	buffer = gtk_entry_get_buffer (GTK_ENTRY (masked_entry));
+	if (GTK_IS_MASKED_ENTRY_BUFFER (buffer))
 		{
-			if (gtk_masked_entry_is_writeable (mask[i]))
-				{
-					newtext[c] = '_';
-				}
-			else
-				{
-					newtext[c] = mask[i];
-				}
+			gtk_entry_buffer_delete_text (buffer, start_pos, end_pos - start_pos);
+		}
+	else
+		{
+			gtk_masked_entry_replace (masked_entry, start_pos, newtext, end_pos - start_pos);
 		}
 
-	if (c > 0)
+	/* GtkEntry moves the cursor only when its buffer changes: over a literal
+	 * or an empty slot nothing changes, and Backspace must still move back */
+	if (cursor > start_pos && cursor <= end_pos)
+		{
+			cursor = start_pos;
+			gtk_editable_set_position (editable, cursor);
+		}
+	else
 		{
-			newtext[c] = '\0';
-			i = start_pos;
-			g_signal_handlers_block_by_func (editable, (gpointer)gtk_masked_entry_insert_text, user_data);
-			g_signal_handlers_block_by_func (editable, (gpointer)gtk_masked_entry_delete_text, user_data);
-			gtk_editable_delete_text (editable, start_pos, end_pos);
-			gtk_editable_insert_text (editable, newtext, c, &i);
-			g_signal_handlers_unblock_by_func (editable, (gpointer)gtk_masked_entry_delete_text, user_data);
-			g_signal_handlers_unblock_by_func (editable, (gpointer)gtk_masked_entry_insert_text, user_data);
+			cursor = gtk_editable_get_position (editable);
 		}
 
-	g_signal_stop_emission_by_name (editable, "delete-text");
-	g_free ((gpointer)mask);
-	g_free ((gpointer)newtext);
+	/* a new mask rewrites the whole text: the cursor is put back on its
+	 * writeable position */
+	gtk_masked_entry_dispatch (masked_entry, &cursor);
+	if (priv->mask != mask)
+		{
+			gtk_editable_set_position (editable, cursor);
+		}
 }
 
 static void
 gtk_masked_entry_insert_text (GtkEditable *editable,
                               const gchar *text,
                               gint         length,
-                              gint        *position,
-                              gpointer     user_data)
+                              gint        *position)
 {
-	G_CONST_RETURN gchar *mask;
-	gchar *newtext;
-	gint i, c = 0, lmask;
+	GtkMaskedEntry *masked_entry = GTK_MASKED_ENTRY (editable);
+	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
+	MaskCore *mask = priv->mask;
 
-	GtkMaskedEntry *masked_entry = GTK_MASKED_ENTRY (user_data);
+	GtkEntryBuffer *buffer;
+	gint c;
 
 	if (text == NULL || length == 0)
 		{
-			gtk_editable_delete_text (editable, 0, gtk_entry_get_max_length (GTK_ENTRY (masked_entry)));
-			g_signal_stop_emission_by_name (editable, "insert-text");
+			gtk_editable_delete_text (editable, 0, -1);
 			return;
 		}
 
-	mask = gtk_masked_entry_get_mask (masked_entry);
-	lmask = strlen (mask);
-	if (lmask == 0 || *position >= lmask)
+	if (priv->burst_typing)
 		{
-			g_signal_stop_emission_by_name (editable, "insert-text");
+			/* one commit of the input method for each key */
+			priv->burst_typing = FALSE;
+			if (length < 0)
+				{
+					length = strlen (text);
+				}
+			gtk_masked_entry_burst_collect (masked_entry, text, length);
 			return;
 		}
 
-	/* get first available position that it is a writeable mask char */
-	*position = gtk_masked_entry_get_first_writeable_mask (masked_entry, GTK_MASKED_ENTRY_RIGHT);
-	
-	newtext = g_new (gchar, MIN (length, lmask));
-
-	/* checking if text is valid */
-	for (i = 0; i < MIN (length, lmask); i++)
+	buffer = gtk_entry_get_buffer (GTK_ENTRY (masked_entry));
+	if (GTK_IS_MASKED_ENTRY_BUFFER (buffer))
 		{
-			if (!gtk_masked_entry_is_writeable (mask[*position + i]))
+			/* the buffer applies the mask itself */
+			if (*position >= 0 && *position < mask->length)
 				{
-					newtext[c++] = mask[*position + i];
+					*position = mask_core_get_first_writeable (mask, *position);
+					*position += gtk_entry_buffer_insert_text (buffer, *position, text, g_utf8_strlen (text, length));
 				}
-			else if (isdigit (text[i]) &&
-			         (mask[*position + i] == '0' || (mask[*position + i] == '9' && text[i] != '0') || mask[*position + i] == '#'))
-				{
-					newtext[c++] = text[i];
-				}
-			else if (isalpha (text[i]) &&
-				  (mask[*position + i] == '@' || mask[*position + i] == '^') || mask[*position + i] == '#')
+		}
+	else
+		{
+			c = mask_core_insert (mask, text, length, position, priv->newtext);
+			if (c > 0)
 				{
-					newtext[c++] = (mask[*position + i] == '^' ? toupper (text[i]) : text[i]);
+					gtk_masked_entry_replace (masked_entry, *position, priv->newtext, c);
+					*position += c;
 				}
-    }
-
-	if (c > 0)
-		{
-			newtext[c] = '\0';
-			g_signal_handlers_block_by_func (editable, (gpointer)gtk_masked_entry_insert_text, user_data);
-			g_signal_handlers_block_by_func (editable, (gpointer)gtk_masked_entry_delete_text, user_data);
-			gtk_editable_delete_text (editable, *position, *position + c);
-			gtk_editable_insert_text (editable, newtext, c, position);
-			g_signal_handlers_unblock_by_func (editable, (gpointer)gtk_masked_entry_delete_text, user_data);
-			g_signal_handlers_unblock_by_func (editable, (gpointer)gtk_masked_entry_insert_text, user_data);
-		}
-  
-	g_signal_stop_emission_by_name (editable, "insert-text");
-	g_free ((gpointer)mask);
-	g_free ((gpointer)newtext);
+		}
+
+	gtk_masked_entry_dispatch (masked_entry, position);
 }
 
 /*
  * private functions
  */
-static gboolean
-gtk_masked_entry_is_writeable (gchar c)
+/*
+ * for buffers other than GtkMaskedEntryBuffer: overwrites the text from
+ * position on with the length characters of newtext, as
+ * gtk_masked_entry_buffer_write() does
+ */
+static void
+gtk_masked_entry_replace (GtkMaskedEntry *masked_entry,
+                          gint position,
+                          const gchar *newtext,
+                          gint length)
 {
-	switch (c)
-		{
-			case '0':               /* digit included 0 */
-			case '9':               /* digit excluded 0 */
-			case '@':               /* alpha */
-			case '^':               /* alpha converted to upper case */
-			case '#':               /* alphanumeric */
-				return TRUE;
+	GtkEntryBuffer *buffer = gtk_entry_get_buffer (GTK_ENTRY (masked_entry));
+	const gchar *text = gtk_entry_buffer_get_text (buffer);
+	gint l = gtk_entry_buffer_get_bytes (buffer);
 
-		  default:
-			return FALSE;
+	while (length > 0 && position < l && text[position] == *newtext)
+		{
+			position++;
+			newtext++;
+			length--;
+		}
+	while (length > 0 && position + length <= l && text[position + length - 1] == newtext[length - 1])
+		{
+			length--;
 		}
-}
-
-static gint
-gtk_masked_entry_get_first_writeable_mask (GtkMaskedEntry *masked_entry,
-                                           GtkMaskedEntryDirections direction)
-{
-	gint i;
-	gint pos;
-	gint lmask;
-
-	pos = gtk_editable_get_position (GTK_EDITABLE (masked_entry));
-	G_CONST_RETURN gchar *mask = gtk_masked_entry_get_mask (masked_entry);
-	lmask = gtk_entry_get_max_length (GTK_ENTRY (masked_entry));
 
-	for (i = pos; (direction == GTK_MASKED_ENTRY_LEFT ? i > 0 : i < lmask);
-		 (direction == GTK_MASKED_ENTRY_LEFT ? i-- : i++))
+	if (length == 0)
 		{
-			if (gtk_masked_entry_is_writeable (mask[i]))
-				{
-					break;
-				}
+			return;
 		}
 
-	return i;
+	g_object_freeze_notify (G_OBJECT (buffer));
+	if (position < l)
+		{
+			gtk_entry_buffer_delete_text (buffer, position, MIN (length, l - position));
+		}
+	gtk_entry_buffer_insert_text (buffer, position, newtext, length);
+	g_object_thaw_notify (G_OBJECT (buffer));
 }
 
-static gint
-gtk_masked_entry_get_next_writeable_block (GtkMaskedEntry *masked_entry,
-                                           GtkMaskedEntryDirections direction)
+/*
+ * makes mask, of which the caller gives a reference, the mask of the entry,
+ * carrying the value over; with keep_slots, every writeable position keeps
+ * its index, the empty ones too, rather than the value being packed
+ */
+static void
+gtk_masked_entry_switch_mask (GtkMaskedEntry *masked_entry,
+                              MaskCore *mask,
+                              gboolean keep_slots)
 {
-	gint i;
-	gint pos;
-	gint lmask;
-	gboolean found = FALSE;
+	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
+	GtkEntryBuffer *buffer = gtk_entry_get_buffer (GTK_ENTRY (masked_entry));
 
-	pos = gtk_editable_get_position (GTK_EDITABLE (masked_entry));
-	G_CONST_RETURN gchar *mask = gtk_masked_entry_get_mask (masked_entry);
-	lmask = gtk_entry_get_max_length (GTK_ENTRY (masked_entry));
+	MaskCore *old_mask;
+	const gchar *text;
+	gint l, s, length;
 
-	if (direction == GTK_MASKED_ENTRY_LEFT)
+	old_mask = priv->mask;
+	priv->mask = mask;
+	if (priv->mask == old_mask)
 		{
-			if (pos == 0)
+			mask_core_unref (old_mask);
+			return;
+		}
+	l = priv->mask->length;
+
+	if (GTK_IS_MASKED_ENTRY_BUFFER (buffer))
+		{
+			priv->newtext = g_renew (gchar, priv->newtext, l + 1);
+			priv->raw = g_renew (gchar, priv->raw, priv->mask->n_writeable + 1);
+
+			if (keep_slots)
 				{
-					i = -1;
+					gtk_masked_entry_buffer_switch_mask (GTK_MASKED_ENTRY_BUFFER (buffer), priv->mask);
 				}
 			else
 				{
-					for (i = pos; i > 0; i--)
-						{
-							if (!gtk_masked_entry_is_writeable (mask[i]))
-								{
-									do
-										{
-											gtk_editable_set_position (GTK_EDITABLE (masked_entry), i);
-											i = gtk_masked_entry_get_first_writeable_mask (masked_entry, direction);
-										} while (gtk_masked_entry_is_writeable (mask[i]) && i > 0);
-									break;
-								}
-						}
+					gtk_masked_entry_buffer_set_mask (GTK_MASKED_ENTRY_BUFFER (buffer), priv->mask);
 				}
 		}
-	else if (direction == GTK_MASKED_ENTRY_RIGHT)
+	else
 		{
-			for (i = pos; i < lmask; i++)
-				{
-					if (!gtk_masked_entry_is_writeable (mask[i]))
-						{
-							found = TRUE;
-							break;
-						}
-				}
-
-			if (found)
+			priv->newtext = g_renew (gchar, priv->newtext, l + 1);
+			text = gtk_entry_buffer_get_text (buffer);
+			if (keep_slots)
 				{
-					gtk_editable_set_position (GTK_EDITABLE (masked_entry), i);
-					i = gtk_masked_entry_get_first_writeable_mask (masked_entry, direction);
-					if (i == lmask)
+					/* the slots as they are, taken with the old mask */
+					length = (gint)gtk_entry_buffer_get_bytes (buffer);
+					for (s = 0; s < old_mask->n_writeable && old_mask->slots[s] < length; s++)
 						{
-							i = -1;
+							priv->raw[s] = text[old_mask->slots[s]];
 						}
+					mask_core_format_slots (priv->mask, priv->raw, s, priv->newtext);
 				}
 			else
 				{
-					i = -1;
+					/* the value without the mask, taken with the old one */
+					mask_core_unformat (old_mask, text, -1, priv->raw);
+					mask_core_format (priv->mask, priv->raw, -1, priv->newtext);
 				}
+			priv->raw = g_renew (gchar, priv->raw, priv->mask->n_writeable + 1);
+
+			g_object_freeze_notify (G_OBJECT (buffer));
+			gtk_entry_buffer_set_max_length (buffer, 0);
+			gtk_entry_buffer_set_text (buffer, priv->newtext, l);
+			gtk_entry_buffer_set_max_length (buffer, l);
+			g_object_thaw_notify (G_OBJECT (buffer));
 		}
 
-	return i;
+	mask_core_unref (old_mask);
+
+	g_object_notify (G_OBJECT (masked_entry), "mask");
 }
 
+/*
+ * with alternative masks, switches to the one of the value after a change;
+ * position, if not NULL, is the cursor of an edit: the writeable positions
+ * keep their index and it is moved to the same one with the new mask
+ */
 static void
-gtk_masked_entry_get_block_positions (GtkMaskedEntry *masked_entry, gint *start, gint *end)
+gtk_masked_entry_dispatch (GtkMaskedEntry *masked_entry,
+                           gint *position)
+{
+	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
+
+	MaskCore *mask;
+	gint s;
+
+	if (priv->masks == NULL)
+		{
+			return;
+		}
+
+	mask = mask_core_set_lookup (priv->masks, gtk_masked_entry_get_text (masked_entry), -1);
+	if (mask == priv->mask)
+		{
+			return;
+		}
+
+	s = 0;
+	if (position != NULL)
+		{
+			s = priv->mask->slot_at[CLAMP (*position, 0, priv->mask->length)];
+		}
+
+	gtk_masked_entry_switch_mask (masked_entry, mask_core_ref (mask), position != NULL);
+
+	if (position != NULL)
+		{
+			*position = (s < mask->n_writeable ? mask->slots[s] : mask->length);
+		}
+}
+
+static gint
+gtk_masked_entry_get_next_writeable_block (GtkMaskedEntry *masked_entry,
+                                           GtkMaskedEntryDirections direction)
 {
-	gint i;
+	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (masked_entry);
+	MaskCore *mask = priv->mask;
+
 	gint pos;
-	gint lmask;
 
-	pos = gtk_editable_get_position (GTK_EDITABLE (masked_entry));
-	G_CONST_RETURN gchar *mask = gtk_masked_entry_get_mask (masked_entry);
-	lmask = gtk_entry_get_max_length (GTK_ENTRY (masked_entry));
+	pos = CLAMP (gtk_editable_get_position (GTK_EDITABLE (masked_entry)), 0, mask->length);
+
+	return (direction == GTK_MASKED_ENTRY_LEFT ? mask->prev_block[pos] : mask->next_block[pos]);
+}
+
+static void
+gtk_masked_entry_notify (GObject *object, GParamSpec *pspec)
+{
+	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (object);
+
+	gboolean valid, complete;
+	gint filled_count;
 
-	for (i = pos; i > 0; i--)
+	/* GtkEntry notifies "text" once for every change of its buffer */
+	if (strcmp (pspec->name, "text") == 0)
 		{
-			if (!gtk_masked_entry_is_writeable (mask[i]))
+			g_object_notify (object, "raw-text");
+
+			filled_count = gtk_masked_entry_get_filled_count (GTK_MASKED_ENTRY (object));
+			if (filled_count != priv->filled_count)
 				{
-					break;
+					priv->filled_count = filled_count;
+					g_object_notify (object, "filled-count");
 				}
-		}
-	*start = i;
 
-	for (i = pos; i < lmask; i++)
-		{
-			if (!gtk_masked_entry_is_writeable (mask[i]))
+			complete = (filled_count == priv->mask->n_writeable);
+			if (complete != priv->complete)
 				{
-					break;
+					priv->complete = complete;
+					g_object_notify (object, "is-complete");
 				}
+
+			valid = gtk_masked_entry_get_valid (GTK_MASKED_ENTRY (object));
+			if (valid != priv->valid)
+				{
+					priv->valid = valid;
+					g_object_notify (object, "valid");
+				}
+		}
+
+	if (G_OBJECT_CLASS (gtk_masked_entry_parent_class)->notify != NULL)
+		{
+			G_OBJECT_CLASS (gtk_masked_entry_parent_class)->notify (object, pspec);
+		}
+}
+
+static void
+gtk_masked_entry_finalize (GObject *object)
+{
+	GtkMaskedEntryPrivate *priv = GTK_MASKED_ENTRY_GET_PRIVATE (object);
+
+	if (priv->burst_source != 0)
+		{
+			g_source_remove (priv->burst_source);
+			priv->burst_source = 0;
 		}
-	*end = i;
+	g_string_free (priv->burst, TRUE);
+	priv->burst = NULL;
+
+	mask_core_unref (priv->mask);
+	priv->mask = NULL;
+	mask_core_set_unref (priv->masks);
+	priv->masks = NULL;
+	g_free (priv->newtext);
+	priv->newtext = NULL;
+	g_free (priv->raw);
+	priv->raw = NULL;
+
+	G_OBJECT_CLASS (gtk_masked_entry_parent_class)->finalize (object);
 }
 
 static void
@@ -568,6 +1103,15 @@ gtk_masked_entry_set_property (GObject *object, guint property_id, const GValue
 				priv->tab_inside = g_value_get_boolean (value);
 				break;
 
+			case PROP_RAW_TEXT:
+				gtk_masked_entry_set_text (masked_entry, g_value_get_string (value));
+				break;
+
+			case PROP_BURST_INTERVAL:
+				gtk_masked_entry_burst_flush (masked_entry);
+				priv->burst_interval = g_value_get_uint (value);
+				break;
+
 			default:
 				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
 				break;
@@ -591,6 +1135,26 @@ gtk_masked_entry_get_property (GObject *object, guint property_id, GValue *value
 				g_value_set_boolean (value, priv->tab_inside);
 				break;
 
+			case PROP_RAW_TEXT:
+				g_value_set_string (value, gtk_masked_entry_get_text (masked_entry));
+				break;
+
+			case PROP_BURST_INTERVAL:
+				g_value_set_uint (value, priv->burst_interval);
+				break;
+
+			case PROP_VALID:
+				g_value_set_boolean (value, gtk_masked_entry_get_valid (masked_entry));
+				break;
+
+			case PROP_IS_COMPLETE:
+				g_value_set_boolean (value, gtk_masked_entry_is_complete (masked_entry));
+				break;
+
+			case PROP_FILLED_COUNT:
+				g_value_set_int (value, gtk_masked_entry_get_filled_count (masked_entry));
+				break;
+
 			default:
 				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
 				break;
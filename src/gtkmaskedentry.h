@@ -47,6 +47,15 @@ struct _GtkMaskedEntry
 struct _GtkMaskedEntryClass
 {
 	GtkEntryClass parent_class;
+
+	void (*scan_complete) (GtkMaskedEntry *masked_entry);
+
+	/* padding for signals added later, without changing the size of the
+	 * class */
+	void (*_gtk_masked_entry_reserved1) (void);
+	void (*_gtk_masked_entry_reserved2) (void);
+	void (*_gtk_masked_entry_reserved3) (void);
+	void (*_gtk_masked_entry_reserved4) (void);
 };
 
 
@@ -57,9 +66,17 @@ GtkWidget *gtk_masked_entry_new_with_mask (const gchar *mask);
 
 void gtk_masked_entry_set_mask (GtkMaskedEntry *masked_entry,
                                 const gchar *mask);
+void gtk_masked_entry_add_mask (GtkMaskedEntry *masked_entry,
+                                const gchar *prefix,
+                                const gchar *mask);
 
 G_CONST_RETURN gchar *gtk_masked_entry_get_mask (GtkMaskedEntry *masked_entry);
 G_CONST_RETURN gchar *gtk_masked_entry_get_text (GtkMaskedEntry *masked_entry);
+void gtk_masked_entry_set_text (GtkMaskedEntry *masked_entry,
+                                const gchar *text);
+gint gtk_masked_entry_get_filled_count (GtkMaskedEntry *masked_entry);
+gboolean gtk_masked_entry_is_complete (GtkMaskedEntry *masked_entry);
+gboolean gtk_masked_entry_get_valid (GtkMaskedEntry *masked_entry);
 
 
 G_END_DECLS
@@ -0,0 +1,565 @@
+/*
+ * GtkMaskedEntryBuffer: the text of GtkMaskedEntry
+ * Copyright (C) 2005-2014 Andrea Zagli <azagli@libero.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+	#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "gtkmaskedentrybuffer.h"
+
+static void gtk_masked_entry_buffer_class_init (GtkMaskedEntryBufferClass *klass);
+static void gtk_masked_entry_buffer_init (GtkMaskedEntryBuffer *buffer);
+
+static const gchar *gtk_masked_entry_buffer_get_text (GtkEntryBuffer *buffer,
+                                                      gsize *n_bytes);
+static guint gtk_masked_entry_buffer_get_length (GtkEntryBuffer *buffer);
+static guint gtk_masked_entry_buffer_insert_text (GtkEntryBuffer *buffer,
+                                                  guint position,
+                                                  const gchar *chars,
+                                                  guint n_chars);
+static guint gtk_masked_entry_buffer_delete_text (GtkEntryBuffer *buffer,
+                                                  guint position,
+                                                  guint n_chars);
+
+static void gtk_masked_entry_buffer_apply_mask (GtkMaskedEntryBuffer *buffer,
+                                                MaskCore *mask,
+                                                gboolean keep_slots);
+static void gtk_masked_entry_buffer_write (GtkMaskedEntryBuffer *buffer,
+                                           gint position,
+                                           const gchar *chars,
+                                           gint length);
+
+static void gtk_masked_entry_buffer_check (GtkMaskedEntryBuffer *buffer);
+
+static void gtk_masked_entry_buffer_finalize (GObject *object);
+
+#define GTK_MASKED_ENTRY_BUFFER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GTK_TYPE_MASKED_ENTRY_BUFFER, GtkMaskedEntryBufferPrivate))
+
+typedef struct _GtkMaskedEntryBufferPrivate GtkMaskedEntryBufferPrivate;
+struct _GtkMaskedEntryBufferPrivate
+	{
+		MaskCore *mask;
+
+		/* the characters of the writeable positions, in order, with
+		 * MASK_CORE_PLACEHOLDER where there is none yet */
+		gchar *slots;
+		gint n_filled;
+
+		/* the value without the mask, kept for the first raw_slot slots,
+		 * whose raw_length filled characters it holds; it is completed
+		 * from slots only when it is asked for */
+		gchar *raw;
+		gint raw_slot;
+		gint raw_length;
+
+		/* the text shown, rebuilt from slots only when it is asked for */
+		gchar *display;
+		gboolean display_dirty;
+
+		/* the states of the check digits of the mask before every slot,
+		 * see mask_core_check_step(), good for the first n_checked + 1 */
+		gint *checks;
+		gint n_checked;
+
+		/* scratch buffer for the text to write, sized from the mask */
+		gchar *scratch;
+	};
+
+G_DEFINE_TYPE (GtkMaskedEntryBuffer, gtk_masked_entry_buffer, GTK_TYPE_ENTRY_BUFFER)
+
+static void
+gtk_masked_entry_buffer_class_init (GtkMaskedEntryBufferClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	GtkEntryBufferClass *buffer_class = GTK_ENTRY_BUFFER_CLASS (klass);
+
+	g_type_class_add_private (object_class, sizeof (GtkMaskedEntryBufferPrivate));
+
+	object_class->finalize = gtk_masked_entry_buffer_finalize;
+
+	buffer_class->get_text = gtk_masked_entry_buffer_get_text;
+	buffer_class->get_length = gtk_masked_entry_buffer_get_length;
+	buffer_class->insert_text = gtk_masked_entry_buffer_insert_text;
+	buffer_class->delete_text = gtk_masked_entry_buffer_delete_text;
+}
+
+static void
+gtk_masked_entry_buffer_init (GtkMaskedEntryBuffer *buffer)
+{
+	GtkMaskedEntryBufferPrivate *priv = GTK_MASKED_ENTRY_BUFFER_GET_PRIVATE (buffer);
+
+	priv->mask = mask_core_intern ("");
+	priv->slots = g_strdup ("");
+	priv->n_filled = 0;
+	priv->raw = g_strdup ("");
+	priv->raw_slot = 0;
+	priv->raw_length = 0;
+	priv->display = g_strdup ("");
+	priv->display_dirty = FALSE;
+	priv->checks = g_new0 (gint, 1);
+	priv->n_checked = 0;
+	priv->scratch = g_new0 (gchar, 1);
+}
+
+/**
+ * gtk_masked_entry_buffer_new:
+ * @mask: (allow-none): the compiled mask, or %NULL.
+ *
+ * Creates a new #GtkMaskedEntryBuffer. It keeps only the characters of the
+ * writeable positions of @mask, the text shown is built from them and from
+ * the literals of @mask. Its length is always the length of @mask: inserting
+ * overwrites the text, deleting puts back the empty mask.
+ *
+ * Returns: the newly created #GtkMaskedEntryBuffer.
+ */
+GtkEntryBuffer
+*gtk_masked_entry_buffer_new (MaskCore *mask)
+{
+	GtkEntryBuffer *buffer = GTK_ENTRY_BUFFER (g_object_new (gtk_masked_entry_buffer_get_type (), NULL));
+
+	if (mask != NULL)
+		{
+			gtk_masked_entry_buffer_set_mask (GTK_MASKED_ENTRY_BUFFER (buffer), mask);
+		}
+
+	return buffer;
+}
+
+/**
+ * gtk_masked_entry_buffer_set_mask:
+ * @buffer: a #GtkMaskedEntryBuffer.
+ * @mask: the compiled mask.
+ *
+ * Sets the mask. The value without the mask is carried over: it fills the
+ * new mask as far as the new mask accepts it, as one change of the buffer.
+ */
+void
+gtk_masked_entry_buffer_set_mask (GtkMaskedEntryBuffer *buffer,
+                                  MaskCore *mask)
+{
+	g_return_if_fail (GTK_IS_MASKED_ENTRY_BUFFER (buffer));
+	g_return_if_fail (mask != NULL);
+
+	gtk_masked_entry_buffer_apply_mask (buffer, mask, FALSE);
+}
+
+/**
+ * gtk_masked_entry_buffer_switch_mask:
+ * @buffer: a #GtkMaskedEntryBuffer.
+ * @mask: the compiled mask.
+ *
+ * Sets the mask as gtk_masked_entry_buffer_set_mask() does, but every
+ * writeable position keeps its index, empty ones included: see
+ * mask_core_format_slots(). It is how #GtkMaskedEntry moves between its
+ * alternative masks while a value is edited.
+ */
+void
+gtk_masked_entry_buffer_switch_mask (GtkMaskedEntryBuffer *buffer,
+                                     MaskCore *mask)
+{
+	g_return_if_fail (GTK_IS_MASKED_ENTRY_BUFFER (buffer));
+	g_return_if_fail (mask != NULL);
+
+	gtk_masked_entry_buffer_apply_mask (buffer, mask, TRUE);
+}
+
+/**
+ * gtk_masked_entry_buffer_get_mask:
+ * @buffer: a #GtkMaskedEntryBuffer.
+ *
+ * Returns: (transfer none): the compiled mask.
+ */
+MaskCore
+*gtk_masked_entry_buffer_get_mask (GtkMaskedEntryBuffer *buffer)
+{
+	GtkMaskedEntryBufferPrivate *priv = GTK_MASKED_ENTRY_BUFFER_GET_PRIVATE (buffer);
+
+	return priv->mask;
+}
+
+/**
+ * gtk_masked_entry_buffer_get_slots:
+ * @buffer: a #GtkMaskedEntryBuffer.
+ *
+ * Returns: the characters of every writeable position of the mask, in order,
+ * with #MASK_CORE_PLACEHOLDER on the empty ones. It is owned by @buffer and
+ * changes with it.
+ */
+G_CONST_RETURN gchar
+*gtk_masked_entry_buffer_get_slots (GtkMaskedEntryBuffer *buffer)
+{
+	GtkMaskedEntryBufferPrivate *priv = GTK_MASKED_ENTRY_BUFFER_GET_PRIVATE (buffer);
+
+	return priv->slots;
+}
+
+/**
+ * gtk_masked_entry_buffer_get_raw_length:
+ * @buffer: a #GtkMaskedEntryBuffer.
+ *
+ * Returns: the number of writeable positions filled.
+ */
+gint
+gtk_masked_entry_buffer_get_raw_length (GtkMaskedEntryBuffer *buffer)
+{
+	GtkMaskedEntryBufferPrivate *priv = GTK_MASKED_ENTRY_BUFFER_GET_PRIVATE (buffer);
+
+	return priv->n_filled;
+}
+
+/**
+ * gtk_masked_entry_buffer_get_raw_text:
+ * @buffer: a #GtkMaskedEntryBuffer.
+ *
+ * Gets the characters of the filled writeable positions, in order, as
+ * mask_core_unformat() does on the text shown. The value is kept between
+ * calls and only the part following the first slot changed is rebuilt.
+ *
+ * Returns: the value without the mask. It is owned by @buffer and valid
+ * until the next change.
+ */
+G_CONST_RETURN gchar
+*gtk_masked_entry_buffer_get_raw_text (GtkMaskedEntryBuffer *buffer)
+{
+	GtkMaskedEntryBufferPrivate *priv = GTK_MASKED_ENTRY_BUFFER_GET_PRIVATE (buffer);
+
+	gint i, c;
+
+	c = priv->raw_length;
+	for (i = priv->raw_slot; i < priv->mask->n_writeable && c < priv->n_filled; i++)
+		{
+			if (priv->slots[i] != MASK_CORE_PLACEHOLDER)
+				{
+					priv->raw[c++] = priv->slots[i];
+				}
+		}
+	priv->raw[c] = '\0';
+
+	priv->raw_slot = i;
+	priv->raw_length = c;
+
+	return priv->raw;
+}
+
+/**
+ * gtk_masked_entry_buffer_set_raw_text:
+ * @buffer: a #GtkMaskedEntryBuffer.
+ * @raw: a value without the mask.
+ * @length: the length of @raw in bytes, or -1 if it is nul-terminated.
+ *
+ * Replaces the content of @buffer with @raw, as one change. @raw is taken up
+ * to its first character refused by the mask.
+ *
+ * Returns: the number of characters of @raw taken.
+ */
+gint
+gtk_masked_entry_buffer_set_raw_text (GtkMaskedEntryBuffer *buffer,
+                                      const gchar *raw,
+                                      gssize length)
+{
+	GtkMaskedEntryBufferPrivate *priv = GTK_MASKED_ENTRY_BUFFER_GET_PRIVATE (buffer);
+
+	gint c;
+
+	g_return_val_if_fail (GTK_IS_MASKED_ENTRY_BUFFER (buffer), 0);
+
+	c = mask_core_format (priv->mask, raw, length, priv->scratch);
+	gtk_masked_entry_buffer_write (buffer, 0, priv->scratch, priv->mask->length);
+
+	return c;
+}
+
+/**
+ * gtk_masked_entry_buffer_get_valid:
+ * @buffer: a #GtkMaskedEntryBuffer.
+ *
+ * Tells whether all the writeable positions are filled and the check
+ * digits the mask declares, if any, are right. The state of the check
+ * digits is kept slot by slot as the buffer changes, so that this costs the
+ * same whatever the length of the value.
+ *
+ * Returns: whether the value is complete and valid.
+ */
+gboolean
+gtk_masked_entry_buffer_get_valid (GtkMaskedEntryBuffer *buffer)
+{
+	GtkMaskedEntryBufferPrivate *priv = GTK_MASKED_ENTRY_BUFFER_GET_PRIVATE (buffer);
+	MaskCore *mask = priv->mask;
+
+	return (priv->n_filled == mask->n_writeable
+	        && (mask->checksum == MASK_CORE_CHECKSUM_NONE
+	            || mask_core_check_finish (mask, priv->checks[mask->n_writeable])));
+}
+
+/*
+ * GtkEntryBuffer
+ */
+static const gchar
+*gtk_masked_entry_buffer_get_text (GtkEntryBuffer *buffer,
+                                   gsize *n_bytes)
+{
+	GtkMaskedEntryBufferPrivate *priv = GTK_MASKED_ENTRY_BUFFER_GET_PRIVATE (buffer);
+	MaskCore *mask = priv->mask;
+
+	gint i;
+
+	if (priv->display_dirty)
+		{
+			for (i = 0; i < mask->n_writeable; i++)
+				{
+					priv->display[mask->slots[i]] = priv->slots[i];
+				}
+			priv->display_dirty = FALSE;
+		}
+
+	if (n_bytes != NULL)
+		{
+			*n_bytes = mask->length;
+		}
+
+	return priv->display;
+}
+
+static guint
+gtk_masked_entry_buffer_get_length (GtkEntryBuffer *buffer)
+{
+	GtkMaskedEntryBufferPrivate *priv = GTK_MASKED_ENTRY_BUFFER_GET_PRIVATE (buffer);
+
+	/* characters: masks and classes are ASCII, see mask_core_compile() */
+	return priv->mask->length;
+}
+
+static guint
+gtk_masked_entry_buffer_insert_text (GtkEntryBuffer *buffer,
+                                     guint position,
+                                     const gchar *chars,
+                                     guint n_chars)
+{
+	GtkMaskedEntryBufferPrivate *priv = GTK_MASKED_ENTRY_BUFFER_GET_PRIVATE (buffer);
+
+	gint pos = position;
+	gint c;
+
+	c = mask_core_insert (priv->mask, chars,
+	                      g_utf8_offset_to_pointer (chars, n_chars) - chars,
+	                      &pos, priv->scratch);
+	if (c > 0)
+		{
+			gtk_masked_entry_buffer_write (GTK_MASKED_ENTRY_BUFFER (buffer), pos, priv->scratch, c);
+		}
+
+	return c;
+}
+
+static guint
+gtk_masked_entry_buffer_delete_text (GtkEntryBuffer *buffer,
+                                     guint position,
+                                     guint n_chars)
+{
+	GtkMaskedEntryBufferPrivate *priv = GTK_MASKED_ENTRY_BUFFER_GET_PRIVATE (buffer);
+
+	const gchar *literals;
+	gint start = position;
+	gint end = position + n_chars;
+
+	literals = mask_core_erase (priv->mask, &start, &end);
+	if (literals == NULL)
+		{
+			return 0;
+		}
+
+	gtk_masked_entry_buffer_write (GTK_MASKED_ENTRY_BUFFER (buffer), start, literals, end - start);
+
+	return end - start;
+}
+
+/*
+ * private functions
+ */
+/*
+ * sets the mask, building the new text from the value kept in raw or,
+ * with keep_slots, from the slots as they are
+ */
+static void
+gtk_masked_entry_buffer_apply_mask (GtkMaskedEntryBuffer *buffer,
+                                    MaskCore *mask,
+                                    gboolean keep_slots)
+{
+	GtkMaskedEntryBufferPrivate *priv = GTK_MASKED_ENTRY_BUFFER_GET_PRIVATE (buffer);
+
+	const gchar *raw;
+	gint old_length, s;
+
+	if (mask == priv->mask)
+		{
+			return;
+		}
+
+	old_length = priv->mask->length;
+
+	priv->scratch = g_renew (gchar, priv->scratch, mask->length + 1);
+	if (keep_slots)
+		{
+			priv->n_filled = mask_core_format_slots (mask, priv->slots, priv->mask->n_writeable, priv->scratch);
+		}
+	else
+		{
+			raw = gtk_masked_entry_buffer_get_raw_text (buffer);
+			priv->n_filled = mask_core_format (mask, raw, priv->raw_length, priv->scratch);
+		}
+
+	mask_core_ref (mask);
+	mask_core_unref (priv->mask);
+	priv->mask = mask;
+
+	priv->slots = g_renew (gchar, priv->slots, mask->n_writeable + 1);
+	for (s = 0; s < mask->n_writeable; s++)
+		{
+			priv->slots[s] = priv->scratch[mask->slots[s]];
+		}
+	priv->slots[mask->n_writeable] = '\0';
+
+	priv->raw = g_renew (gchar, priv->raw, mask->n_writeable + 1);
+	priv->raw[0] = '\0';
+	priv->raw_slot = 0;
+	priv->raw_length = 0;
+
+	priv->display = g_renew (gchar, priv->display, mask->length + 1);
+	memcpy (priv->display, priv->scratch, mask->length + 1);
+	priv->display_dirty = FALSE;
+
+	priv->checks = g_renew (gint, priv->checks, mask->n_writeable + 1);
+	priv->checks[0] = MASK_CORE_CHECK_INIT;
+	priv->n_checked = 0;
+	gtk_masked_entry_buffer_check (buffer);
+
+	g_object_freeze_notify (G_OBJECT (buffer));
+	if (old_length > 0)
+		{
+			gtk_entry_buffer_emit_deleted_text (GTK_ENTRY_BUFFER (buffer), 0, old_length);
+		}
+	if (mask->length > 0)
+		{
+			gtk_entry_buffer_emit_inserted_text (GTK_ENTRY_BUFFER (buffer), 0, priv->display, mask->length);
+		}
+	g_object_thaw_notify (G_OBJECT (buffer));
+}
+
+/*
+ * overwrites the text from position on with the length characters of chars,
+ * that follow the mask: literals where it has literals, and on writeable
+ * positions accepted characters or MASK_CORE_PLACEHOLDER; only the span that
+ * actually differs is touched, and its deletion and insertion are notified
+ * as one change
+ */
+static void
+gtk_masked_entry_buffer_write (GtkMaskedEntryBuffer *buffer,
+                               gint position,
+                               const gchar *chars,
+                               gint length)
+{
+	GtkMaskedEntryBufferPrivate *priv = GTK_MASKED_ENTRY_BUFFER_GET_PRIVATE (buffer);
+	MaskCore *mask = priv->mask;
+
+	gint first, last, s, e;
+	gchar *slot;
+
+	/* the slots of the positions written */
+	s = mask->slot_at[position];
+	e = mask->slot_at[position + length];
+
+	for (; s < e && priv->slots[s] == chars[mask->slots[s] - position]; s++);
+	for (; e > s && priv->slots[e - 1] == chars[mask->slots[e - 1] - position]; e--);
+	/* nothing to notify: the cursor is moved back by the entry, see
+	 * gtk_masked_entry_delete_text() */
+	if (s == e)
+		{
+			return;
+		}
+
+	first = mask->slots[s];
+	last = mask->slots[e - 1] + 1;
+
+	/* the value without the mask stays good up to the first slot changed,
+	 * when no slot before it is empty: otherwise where it stops is unknown */
+	if (s < priv->raw_slot)
+		{
+			priv->raw_slot = (priv->raw_length == priv->raw_slot ? s : 0);
+			priv->raw_length = priv->raw_slot;
+		}
+	priv->n_checked = MIN (priv->n_checked, s);
+
+	for (; s < e; s++)
+		{
+			slot = &priv->slots[s];
+			priv->n_filled += (*slot == MASK_CORE_PLACEHOLDER) - (chars[mask->slots[s] - position] == MASK_CORE_PLACEHOLDER);
+			*slot = chars[mask->slots[s] - position];
+		}
+	priv->display_dirty = TRUE;
+	gtk_masked_entry_buffer_check (buffer);
+
+	g_object_freeze_notify (G_OBJECT (buffer));
+	gtk_entry_buffer_emit_deleted_text (GTK_ENTRY_BUFFER (buffer), first, last - first);
+	gtk_entry_buffer_emit_inserted_text (GTK_ENTRY_BUFFER (buffer), first, chars + first - position, last - first);
+	g_object_thaw_notify (G_OBJECT (buffer));
+}
+
+/*
+ * runs the check digits of the mask over the slots following the ones
+ * checked, up to the first empty one: typing at the end of the value costs
+ * one step
+ */
+static void
+gtk_masked_entry_buffer_check (GtkMaskedEntryBuffer *buffer)
+{
+	GtkMaskedEntryBufferPrivate *priv = GTK_MASKED_ENTRY_BUFFER_GET_PRIVATE (buffer);
+	MaskCore *mask = priv->mask;
+
+	gint s;
+
+	if (mask->checksum == MASK_CORE_CHECKSUM_NONE)
+		{
+			return;
+		}
+
+	for (s = priv->n_checked; s < mask->n_writeable && priv->slots[s] != MASK_CORE_PLACEHOLDER; s++)
+		{
+			priv->checks[s + 1] = mask_core_check_step (mask, priv->checks[s], s, priv->slots[s]);
+		}
+	priv->n_checked = s;
+}
+
+static void
+gtk_masked_entry_buffer_finalize (GObject *object)
+{
+	GtkMaskedEntryBufferPrivate *priv = GTK_MASKED_ENTRY_BUFFER_GET_PRIVATE (object);
+
+	mask_core_unref (priv->mask);
+	priv->mask = NULL;
+	g_free (priv->slots);
+	g_free (priv->raw);
+	g_free (priv->display);
+	g_free (priv->checks);
+	g_free (priv->scratch);
+
+	G_OBJECT_CLASS (gtk_masked_entry_buffer_parent_class)->finalize (object);
+}
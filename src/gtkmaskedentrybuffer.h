@@ -0,0 +1,77 @@
+/*
+ * GtkMaskedEntryBuffer: the text of GtkMaskedEntry
+ * Copyright (C) 2005-2014 Andrea Zagli <azagli@libero.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GTK_MASKED_ENTRY_BUFFER_H__
+#define __GTK_MASKED_ENTRY_BUFFER_H__
+
+#include <gtk/gtk.h>
+
+#include "maskcore.h"
+
+
+G_BEGIN_DECLS
+
+
+#define GTK_TYPE_MASKED_ENTRY_BUFFER                 (gtk_masked_entry_buffer_get_type ())
+#define GTK_MASKED_ENTRY_BUFFER(obj)                 (G_TYPE_CHECK_INSTANCE_CAST ((obj), GTK_TYPE_MASKED_ENTRY_BUFFER, GtkMaskedEntryBuffer))
+#define GTK_MASKED_ENTRY_BUFFER_CLASS(klass)         (G_TYPE_CHECK_CLASS_CAST ((klass), GTK_TYPE_MASKED_ENTRY_BUFFER, GtkMaskedEntryBufferClass))
+#define GTK_IS_MASKED_ENTRY_BUFFER(obj)              (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GTK_TYPE_MASKED_ENTRY_BUFFER))
+#define GTK_IS_MASKED_ENTRY_BUFFER_CLASS(klass)      (G_TYPE_CHECK_CLASS_TYPE ((klass), GTK_TYPE_MASKED_ENTRY_BUFFER))
+#define GTK_MASKED_ENTRY_BUFFER_GET_CLASS(obj)       (G_TYPE_INSTANCE_GET_CLASS ((obj), GTK_TYPE_MASKED_ENTRY_BUFFER, GtkMaskedEntryBufferClass))
+
+
+typedef struct _GtkMaskedEntryBuffer        GtkMaskedEntryBuffer;
+typedef struct _GtkMaskedEntryBufferClass   GtkMaskedEntryBufferClass;
+
+
+struct _GtkMaskedEntryBuffer
+{
+	GtkEntryBuffer buffer;
+};
+
+struct _GtkMaskedEntryBufferClass
+{
+	GtkEntryBufferClass parent_class;
+};
+
+
+GType gtk_masked_entry_buffer_get_type (void) G_GNUC_CONST;
+
+GtkEntryBuffer *gtk_masked_entry_buffer_new (MaskCore *mask);
+
+void gtk_masked_entry_buffer_set_mask (GtkMaskedEntryBuffer *buffer,
+                                       MaskCore *mask);
+void gtk_masked_entry_buffer_switch_mask (GtkMaskedEntryBuffer *buffer,
+                                          MaskCore *mask);
+MaskCore *gtk_masked_entry_buffer_get_mask (GtkMaskedEntryBuffer *buffer);
+
+G_CONST_RETURN gchar *gtk_masked_entry_buffer_get_slots (GtkMaskedEntryBuffer *buffer);
+gint gtk_masked_entry_buffer_get_raw_length (GtkMaskedEntryBuffer *buffer);
+G_CONST_RETURN gchar *gtk_masked_entry_buffer_get_raw_text (GtkMaskedEntryBuffer *buffer);
+gint gtk_masked_entry_buffer_set_raw_text (GtkMaskedEntryBuffer *buffer,
+                                           const gchar *raw,
+                                           gssize length);
+gboolean gtk_masked_entry_buffer_get_valid (GtkMaskedEntryBuffer *buffer);
+
+
+G_END_DECLS
+
+
+#endif /* __GTK_MASKED_ENTRY_BUFFER_H__ */
@@ -0,0 +1,424 @@
+/*
+ * GtkMaskedKeys: sorting and searching tree view columns with a mask
+ * Copyright (C) 2005-2014 Andrea Zagli <azagli@libero.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+	#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "maskcore.h"
+#include "gtkmaskedkeys.h"
+
+/* the keys allocated at once */
+#define GTK_MASKED_KEYS_BLOCK 4096
+
+typedef struct _GtkMaskedKeysEntry GtkMaskedKeysEntry;
+struct _GtkMaskedKeysEntry
+	{
+		GtkTreeIter iter;
+		GtkMaskedKeysEntry *next_free;
+		guint value_hash;
+		gchar key[1];
+	};
+
+/**
+ * GtkMaskedKeys:
+ *
+ * The values of a model column without the mask, kept for every row once
+ * computed, to sort and search the column.
+ */
+struct _GtkMaskedKeys
+	{
+		gint ref_count;
+
+		MaskCore *mask;
+		gint column;
+		gboolean formatted;
+
+		/* the keys of the rows of model, found by their iter; they are
+		 * allocated in blocks of GTK_MASKED_KEYS_BLOCK, the ones of the rows
+		 * changed are used again */
+		GtkTreeModel *model;
+		gint stamp;
+		GHashTable *entries;
+		gsize entry_size;
+		GSList *blocks;
+		guint block_used;
+		GtkMaskedKeysEntry *free;
+
+		/* the keys of the rows of models whose iters do not persist */
+		gchar *scratch_a;
+		gchar *scratch_b;
+	};
+
+static void gtk_masked_keys_set_model (GtkMaskedKeys *keys,
+                                       GtkTreeModel *model);
+
+static guint
+gtk_masked_keys_iter_hash (gconstpointer key)
+{
+	const GtkTreeIter *iter = key;
+
+	return g_direct_hash (iter->user_data)
+	       ^ (g_direct_hash (iter->user_data2) * 31)
+	       ^ (g_direct_hash (iter->user_data3) * 961);
+}
+
+static gboolean
+gtk_masked_keys_iter_equal (gconstpointer a, gconstpointer b)
+{
+	const GtkTreeIter *iter_a = a;
+	const GtkTreeIter *iter_b = b;
+
+	return iter_a->user_data == iter_b->user_data
+	       && iter_a->user_data2 == iter_b->user_data2
+	       && iter_a->user_data3 == iter_b->user_data3;
+}
+
+/**
+ * gtk_masked_keys_new:
+ * @mask: the mask of the column.
+ * @model_column: a column of the model, of type G_TYPE_STRING.
+ * @formatted: whether the values of @model_column are formatted with @mask,
+ * or kept without it (see gtk_cell_renderer_masked_set_raw_column()).
+ *
+ * Creates the keys to sort and search @model_column by its values without
+ * the mask, with gtk_masked_keys_compare() and gtk_masked_keys_search_equal():
+ * literals and placeholders do not count.
+ *
+ * The key of a row is computed the first time it is needed, and kept with a
+ * hash of the value it comes from, if the iters of the model persist. The
+ * value is read again at every comparison, since #GtkListStore and
+ * #GtkTreeStore sort a row changed before emitting #GtkTreeModel::row-changed;
+ * the key is computed again only when the hash differs.
+ *
+ * Returns: a new #GtkMaskedKeys, to be released with gtk_masked_keys_unref().
+ */
+GtkMaskedKeys
+*gtk_masked_keys_new (const gchar *mask,
+                      gint model_column,
+                      gboolean formatted)
+{
+	GtkMaskedKeys *keys;
+
+	keys = g_new0 (GtkMaskedKeys, 1);
+	keys->ref_count = 1;
+
+	keys->mask = mask_core_intern (mask);
+	keys->column = model_column;
+	keys->formatted = formatted;
+
+	keys->model = NULL;
+	keys->stamp = 0;
+	keys->entries = g_hash_table_new (gtk_masked_keys_iter_hash,
+	                                  gtk_masked_keys_iter_equal);
+	keys->entry_size = G_STRUCT_OFFSET (GtkMaskedKeysEntry, key)
+	                   + MASK_CORE_UNFORMATTED_SIZE (keys->mask);
+	keys->entry_size = (keys->entry_size + sizeof (gpointer) - 1) & ~(sizeof (gpointer) - 1);
+	keys->blocks = NULL;
+	keys->block_used = 0;
+	keys->free = NULL;
+
+	keys->scratch_a = g_new0 (gchar, MASK_CORE_UNFORMATTED_SIZE (keys->mask));
+	keys->scratch_b = g_new0 (gchar, MASK_CORE_UNFORMATTED_SIZE (keys->mask));
+
+	return keys;
+}
+
+/**
+ * gtk_masked_keys_ref:
+ * @keys: a #GtkMaskedKeys.
+ *
+ * Returns: @keys.
+ */
+GtkMaskedKeys
+*gtk_masked_keys_ref (GtkMaskedKeys *keys)
+{
+	g_return_val_if_fail (keys != NULL, NULL);
+
+	keys->ref_count++;
+
+	return keys;
+}
+
+/**
+ * gtk_masked_keys_unref:
+ * @keys: a #GtkMaskedKeys.
+ *
+ * Releases a reference to @keys, freeing it with the last one. It can be
+ * given as #GDestroyNotify to gtk_tree_sortable_set_sort_func() and
+ * gtk_tree_view_set_search_equal_func().
+ */
+void
+gtk_masked_keys_unref (GtkMaskedKeys *keys)
+{
+	g_return_if_fail (keys != NULL);
+
+	if (--keys->ref_count > 0)
+		{
+			return;
+		}
+
+	gtk_masked_keys_set_model (keys, NULL);
+	g_hash_table_destroy (keys->entries);
+
+	mask_core_unref (keys->mask);
+	g_free (keys->scratch_a);
+	g_free (keys->scratch_b);
+	g_free (keys);
+}
+
+static void
+gtk_masked_keys_clear (GtkMaskedKeys *keys)
+{
+	g_hash_table_remove_all (keys->entries);
+
+	g_slist_free_full (keys->blocks, g_free);
+	keys->blocks = NULL;
+	keys->block_used = 0;
+	keys->free = NULL;
+}
+
+static void
+gtk_masked_keys_row_changed (GtkTreeModel *model,
+                             GtkTreePath *path,
+                             GtkTreeIter *iter,
+                             gpointer data)
+{
+	GtkMaskedKeys *keys = data;
+	GtkMaskedKeysEntry *entry;
+
+	entry = g_hash_table_lookup (keys->entries, iter);
+	if (entry != NULL)
+		{
+			g_hash_table_remove (keys->entries, &entry->iter);
+			entry->next_free = keys->free;
+			keys->free = entry;
+		}
+}
+
+/* the iter of the row deleted is no longer valid, and could be given to a
+ * new row: all the keys go */
+static void
+gtk_masked_keys_row_deleted (GtkTreeModel *model,
+                             GtkTreePath *path,
+                             gpointer data)
+{
+	gtk_masked_keys_clear (data);
+}
+
+static void
+gtk_masked_keys_model_finalized (gpointer data,
+                                 GObject *model)
+{
+	GtkMaskedKeys *keys = data;
+
+	keys->model = NULL;
+	gtk_masked_keys_clear (keys);
+}
+
+/* the model is not referenced: the keys are usually given to the model
+ * itself, with gtk_tree_sortable_set_sort_func() */
+static void
+gtk_masked_keys_set_model (GtkMaskedKeys *keys,
+                           GtkTreeModel *model)
+{
+	gtk_masked_keys_clear (keys);
+
+	if (keys->model != NULL)
+		{
+			g_signal_handlers_disconnect_matched (keys->model, G_SIGNAL_MATCH_DATA,
+			                                      0, 0, NULL, NULL, keys);
+			g_object_weak_unref (G_OBJECT (keys->model), gtk_masked_keys_model_finalized, keys);
+			keys->model = NULL;
+		}
+
+	if (model != NULL)
+		{
+			keys->model = model;
+			keys->stamp = 0;
+			g_object_weak_ref (G_OBJECT (model), gtk_masked_keys_model_finalized, keys);
+			g_signal_connect (model, "row-changed",
+			                  G_CALLBACK (gtk_masked_keys_row_changed), keys);
+			g_signal_connect (model, "row-deleted",
+			                  G_CALLBACK (gtk_masked_keys_row_deleted), keys);
+		}
+}
+
+static void
+gtk_masked_keys_compute (GtkMaskedKeys *keys,
+                         const gchar *value,
+                         gchar *key)
+{
+	if (value == NULL)
+		{
+			key[0] = '\0';
+		}
+	else if (keys->formatted)
+		{
+			mask_core_unformat (keys->mask, value, -1, key);
+		}
+	else
+		{
+			g_strlcpy (key, value, MASK_CORE_UNFORMATTED_SIZE (keys->mask));
+		}
+}
+
+/* the key of a row: the one kept, or computed in scratch */
+static const gchar
+*gtk_masked_keys_get (GtkMaskedKeys *keys,
+                      GtkTreeModel *model,
+                      GtkTreeIter *iter,
+                      gchar *scratch)
+{
+	GtkMaskedKeysEntry *entry;
+	gchar *value;
+	guint hash;
+
+	if (model != keys->model)
+		{
+			gtk_masked_keys_set_model (keys, model);
+		}
+	if (iter->stamp != keys->stamp)
+		{
+			gtk_masked_keys_clear (keys);
+			keys->stamp = iter->stamp;
+		}
+
+	value = NULL;
+	gtk_tree_model_get (model, iter, keys->column, &value, -1);
+
+	if ((gtk_tree_model_get_flags (model) & GTK_TREE_MODEL_ITERS_PERSIST) == 0)
+		{
+			gtk_masked_keys_compute (keys, value, scratch);
+			g_free (value);
+			return scratch;
+		}
+
+	/* the row may have changed without "row-changed" yet */
+	hash = (value != NULL ? g_str_hash (value) : 0);
+	entry = g_hash_table_lookup (keys->entries, iter);
+	if (entry != NULL)
+		{
+			if (entry->value_hash != hash)
+				{
+					gtk_masked_keys_compute (keys, value, entry->key);
+					entry->value_hash = hash;
+				}
+			g_free (value);
+			return entry->key;
+		}
+
+	if (keys->free != NULL)
+		{
+			entry = keys->free;
+			keys->free = entry->next_free;
+		}
+	else
+		{
+			if (keys->blocks == NULL || keys->block_used == GTK_MASKED_KEYS_BLOCK)
+				{
+					keys->blocks = g_slist_prepend (keys->blocks,
+					                                g_malloc (keys->entry_size * GTK_MASKED_KEYS_BLOCK));
+					keys->block_used = 0;
+				}
+			entry = (GtkMaskedKeysEntry *)((gchar *)keys->blocks->data
+			                               + keys->entry_size * keys->block_used++);
+		}
+
+	entry->iter = *iter;
+	entry->next_free = NULL;
+	entry->value_hash = hash;
+	gtk_masked_keys_compute (keys, value, entry->key);
+	g_hash_table_insert (keys->entries, &entry->iter, entry);
+	g_free (value);
+
+	return entry->key;
+}
+
+/**
+ * gtk_masked_keys_compare:
+ * @model: a #GtkTreeModel.
+ * @a: a row of @model.
+ * @b: another row of @model.
+ * @keys: a #GtkMaskedKeys.
+ *
+ * A #GtkTreeIterCompareFunc comparing the values without the mask of @a and
+ * @b, to be given with @keys to gtk_tree_sortable_set_sort_func(). A value
+ * not complete comes before the complete values it starts.
+ *
+ * Returns: a negative integer, zero or a positive integer as @a comes before,
+ * with or after @b.
+ */
+gint
+gtk_masked_keys_compare (GtkTreeModel *model,
+                         GtkTreeIter *a,
+                         GtkTreeIter *b,
+                         gpointer keys)
+{
+	GtkMaskedKeys *k = keys;
+
+	return strcmp (gtk_masked_keys_get (k, model, a, k->scratch_a),
+	               gtk_masked_keys_get (k, model, b, k->scratch_b));
+}
+
+/**
+ * gtk_masked_keys_search_equal:
+ * @model: a #GtkTreeModel.
+ * @column: the search column of the view; the column of @keys is searched
+ * instead.
+ * @key: the text typed.
+ * @iter: a row of @model.
+ * @keys: a #GtkMaskedKeys.
+ *
+ * A #GtkTreeViewSearchEqualFunc, to be given with @keys to
+ * gtk_tree_view_set_search_equal_func(): a row matches when its value
+ * without the mask starts with the letters and digits typed, in any case.
+ * Anything else typed, as the literals of the mask, is skipped.
+ *
+ * Returns: %FALSE if the row matches, as #GtkTreeViewSearchEqualFunc wants.
+ */
+gboolean
+gtk_masked_keys_search_equal (GtkTreeModel *model,
+                              gint column,
+                              const gchar *key,
+                              GtkTreeIter *iter,
+                              gpointer keys)
+{
+	GtkMaskedKeys *k = keys;
+	const gchar *row;
+
+	row = gtk_masked_keys_get (k, model, iter, k->scratch_a);
+	for (; *key != '\0'; key++)
+		{
+			if (!g_ascii_isalnum (*key))
+				{
+					continue;
+				}
+			if (*row == '\0' || g_ascii_tolower (*row) != g_ascii_tolower (*key))
+				{
+					return TRUE;
+				}
+			row++;
+		}
+
+	return FALSE;
+}
@@ -0,0 +1,53 @@
+/*
+ * GtkMaskedKeys: sorting and searching tree view columns with a mask
+ * Copyright (C) 2005-2014 Andrea Zagli <azagli@libero.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GTK_MASKED_KEYS_H__
+#define __GTK_MASKED_KEYS_H__
+
+#include <gtk/gtk.h>
+
+
+G_BEGIN_DECLS
+
+
+typedef struct _GtkMaskedKeys GtkMaskedKeys;
+
+
+GtkMaskedKeys *gtk_masked_keys_new (const gchar *mask,
+                                    gint model_column,
+                                    gboolean formatted);
+GtkMaskedKeys *gtk_masked_keys_ref (GtkMaskedKeys *keys);
+void gtk_masked_keys_unref (GtkMaskedKeys *keys);
+
+gint gtk_masked_keys_compare (GtkTreeModel *model,
+                              GtkTreeIter *a,
+                              GtkTreeIter *b,
+                              gpointer keys);
+gboolean gtk_masked_keys_search_equal (GtkTreeModel *model,
+                                       gint column,
+                                       const gchar *key,
+                                       GtkTreeIter *iter,
+                                       gpointer keys);
+
+
+G_END_DECLS
+
+
+#endif /* __GTK_MASKED_KEYS_H__ */
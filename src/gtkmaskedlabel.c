@@ -0,0 +1,294 @@
+/*
+ * GtkMaskedLabel widget for GTK+
+ * Copyright (C) 2005-2014 Andrea Zagli <azagli@libero.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+	#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "maskcore.h"
+#include "gtkmaskedlabel.h"
+
+/* the formatted text of masks up to this length is made on the stack */
+#define GTK_MASKED_LABEL_STACK_SIZE 128
+
+enum
+{
+	PROP_0,
+	PROP_MASK,
+	PROP_RAW_TEXT
+};
+
+static void gtk_masked_label_class_init (GtkMaskedLabelClass *klass);
+static void gtk_masked_label_init (GtkMaskedLabel *masked_label);
+
+static void gtk_masked_label_update (GtkMaskedLabel *masked_label);
+
+static void gtk_masked_label_finalize (GObject *object);
+static void gtk_masked_label_set_property (GObject *object,
+                                           guint property_id,
+                                           const GValue *value,
+                                           GParamSpec *pspec);
+static void gtk_masked_label_get_property (GObject *object,
+                                           guint property_id,
+                                           GValue *value,
+                                           GParamSpec *pspec);
+
+#define GTK_MASKED_LABEL_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GTK_TYPE_MASKED_LABEL, GtkMaskedLabelPrivate))
+
+/* all a value shown needs: the compiled mask is shared by all the widgets
+ * with the same mask, see mask_core_intern() */
+typedef struct _GtkMaskedLabelPrivate GtkMaskedLabelPrivate;
+struct _GtkMaskedLabelPrivate
+	{
+		MaskCore *mask;
+		gchar *raw;
+	};
+
+G_DEFINE_TYPE (GtkMaskedLabel, gtk_masked_label, GTK_TYPE_LABEL)
+
+static void
+gtk_masked_label_class_init (GtkMaskedLabelClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (object_class, sizeof (GtkMaskedLabelPrivate));
+
+	object_class->set_property = gtk_masked_label_set_property;
+	object_class->get_property = gtk_masked_label_get_property;
+	object_class->finalize = gtk_masked_label_finalize;
+
+	g_object_class_install_property (object_class, PROP_MASK,
+	                                 g_param_spec_string ("mask",
+	                                                      "The mask",
+	                                                      "The mask",
+	                                                      "",
+	                                                      G_PARAM_READWRITE));
+	g_object_class_install_property (object_class, PROP_RAW_TEXT,
+	                                 g_param_spec_string ("raw-text",
+	                                                      "The text without the mask",
+	                                                      "The value shown, formatted with the mask",
+	                                                      "",
+	                                                      G_PARAM_READWRITE));
+}
+
+static void
+gtk_masked_label_init (GtkMaskedLabel *masked_label)
+{
+	GtkMaskedLabelPrivate *priv = GTK_MASKED_LABEL_GET_PRIVATE (masked_label);
+
+	priv->mask = mask_core_intern ("");
+	priv->raw = NULL;
+}
+
+/**
+ * gtk_masked_label_new:
+ * @mask: the mask (see gtk_masked_entry_new_with_mask() for explanation).
+ * @text: the value to show, without the mask, or %NULL.
+ *
+ * Creates a new #GtkMaskedLabel, showing @text formatted with @mask. It is
+ * a #GtkLabel: it has none of the buffer, input method and cursor of a
+ * #GtkMaskedEntry, for the values that are never edited.
+ *
+ * Returns: the newly created #GtkMaskedLabel widget.
+ */
+GtkWidget*
+gtk_masked_label_new (const gchar *mask,
+                      const gchar *text)
+{
+	GtkWidget *masked_label = GTK_WIDGET (g_object_new (gtk_masked_label_get_type (), NULL));
+	GtkMaskedLabelPrivate *priv = GTK_MASKED_LABEL_GET_PRIVATE (masked_label);
+
+	/* formatted once */
+	mask_core_unref (priv->mask);
+	priv->mask = mask_core_intern (mask);
+	priv->raw = g_strdup (text);
+	gtk_masked_label_update (GTK_MASKED_LABEL (masked_label));
+
+	return masked_label;
+}
+
+/**
+ * gtk_masked_label_set_mask:
+ * @masked_label: a #GtkMaskedLabel.
+ * @mask: the mask.
+ *
+ * Sets the mask, and shows the value formatted with it.
+ */
+void
+gtk_masked_label_set_mask (GtkMaskedLabel *masked_label,
+                           const gchar    *mask)
+{
+	GtkMaskedLabelPrivate *priv = GTK_MASKED_LABEL_GET_PRIVATE (masked_label);
+
+	g_return_if_fail (GTK_IS_MASKED_LABEL (masked_label));
+
+	mask_core_unref (priv->mask);
+	priv->mask = mask_core_intern (mask);
+	gtk_masked_label_update (masked_label);
+
+	g_object_notify (G_OBJECT (masked_label), "mask");
+}
+
+/**
+ * gtk_masked_label_get_mask:
+ * @masked_label: a #GtkMaskedLabel.
+ *
+ * Returns: the mask as a string.
+ */
+G_CONST_RETURN gchar*
+gtk_masked_label_get_mask (GtkMaskedLabel *masked_label)
+{
+	GtkMaskedLabelPrivate *priv = GTK_MASKED_LABEL_GET_PRIVATE (masked_label);
+
+	g_return_val_if_fail (GTK_IS_MASKED_LABEL (masked_label), NULL);
+
+	return priv->mask->text;
+}
+
+/**
+ * gtk_masked_label_set_text:
+ * @masked_label: a #GtkMaskedLabel.
+ * @text: the value to show, without the mask, or %NULL.
+ *
+ * Shows @text formatted with the mask; an empty value shows nothing.
+ */
+void
+gtk_masked_label_set_text (GtkMaskedLabel *masked_label,
+                           const gchar    *text)
+{
+	GtkMaskedLabelPrivate *priv = GTK_MASKED_LABEL_GET_PRIVATE (masked_label);
+
+	g_return_if_fail (GTK_IS_MASKED_LABEL (masked_label));
+
+	if (g_strcmp0 (priv->raw, text) == 0)
+		{
+			return;
+		}
+
+	g_free (priv->raw);
+	priv->raw = g_strdup (text);
+	gtk_masked_label_update (masked_label);
+
+	g_object_notify (G_OBJECT (masked_label), "raw-text");
+}
+
+/**
+ * gtk_masked_label_get_text:
+ * @masked_label: a #GtkMaskedLabel.
+ *
+ * Returns: the value shown, without the mask, as given to
+ * gtk_masked_label_set_text(). It is owned by the widget.
+ */
+G_CONST_RETURN gchar*
+gtk_masked_label_get_text (GtkMaskedLabel *masked_label)
+{
+	GtkMaskedLabelPrivate *priv = GTK_MASKED_LABEL_GET_PRIVATE (masked_label);
+
+	g_return_val_if_fail (GTK_IS_MASKED_LABEL (masked_label), NULL);
+
+	return priv->raw != NULL ? priv->raw : "";
+}
+
+static void
+gtk_masked_label_update (GtkMaskedLabel *masked_label)
+{
+	GtkMaskedLabelPrivate *priv = GTK_MASKED_LABEL_GET_PRIVATE (masked_label);
+
+	gchar stack[GTK_MASKED_LABEL_STACK_SIZE];
+	gchar *text;
+
+	if (priv->raw == NULL || priv->raw[0] == '\0')
+		{
+			gtk_label_set_text (GTK_LABEL (masked_label), "");
+			return;
+		}
+
+	text = (MASK_CORE_FORMATTED_SIZE (priv->mask) <= sizeof (stack)
+	        ? stack
+	        : g_new (gchar, MASK_CORE_FORMATTED_SIZE (priv->mask)));
+	mask_core_format (priv->mask, priv->raw, -1, text);
+	gtk_label_set_text (GTK_LABEL (masked_label), text);
+
+	if (text != stack)
+		{
+			g_free (text);
+		}
+}
+
+static void
+gtk_masked_label_finalize (GObject *object)
+{
+	GtkMaskedLabelPrivate *priv = GTK_MASKED_LABEL_GET_PRIVATE (object);
+
+	mask_core_unref (priv->mask);
+	g_free (priv->raw);
+
+	G_OBJECT_CLASS (gtk_masked_label_parent_class)->finalize (object);
+}
+
+static void
+gtk_masked_label_set_property (GObject *object,
+                               guint property_id,
+                               const GValue *value,
+                               GParamSpec *pspec)
+{
+	GtkMaskedLabel *masked_label = GTK_MASKED_LABEL (object);
+
+	switch (property_id)
+		{
+			case PROP_MASK:
+				gtk_masked_label_set_mask (masked_label, g_value_get_string (value));
+				break;
+
+			case PROP_RAW_TEXT:
+				gtk_masked_label_set_text (masked_label, g_value_get_string (value));
+				break;
+
+			default:
+				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+				break;
+		}
+}
+
+static void
+gtk_masked_label_get_property (GObject *object,
+                               guint property_id,
+                               GValue *value,
+                               GParamSpec *pspec)
+{
+	GtkMaskedLabel *masked_label = GTK_MASKED_LABEL (object);
+
+	switch (property_id)
+		{
+			case PROP_MASK:
+				g_value_set_string (value, gtk_masked_label_get_mask (masked_label));
+				break;
+
+			case PROP_RAW_TEXT:
+				g_value_set_string (value, gtk_masked_label_get_text (masked_label));
+				break;
+
+			default:
+				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+				break;
+		}
+}
@@ -0,0 +1,70 @@
+/*
+ * GtkMaskedLabel widget for GTK+
+ * Copyright (C) 2005-2014 Andrea Zagli <azagli@libero.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GTK_MASKED_LABEL_H__
+#define __GTK_MASKED_LABEL_H__
+
+#include <gtk/gtk.h>
+
+
+G_BEGIN_DECLS
+
+
+#define GTK_TYPE_MASKED_LABEL                 (gtk_masked_label_get_type ())
+#define GTK_MASKED_LABEL(obj)                 (G_TYPE_CHECK_INSTANCE_CAST ((obj), GTK_TYPE_MASKED_LABEL, GtkMaskedLabel))
+#define GTK_MASKED_LABEL_CLASS(klass)         (G_TYPE_CHECK_CLASS_CAST ((klass), GTK_TYPE_MASKED_LABEL, GtkMaskedLabelClass))
+#define GTK_IS_MASKED_LABEL(obj)              (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GTK_TYPE_MASKED_LABEL))
+#define GTK_IS_MASKED_LABEL_CLASS(klass)      (G_TYPE_CHECK_CLASS_TYPE ((klass), GTK_TYPE_MASKED_LABEL))
+#define GTK_MASKED_LABEL_GET_CLASS(obj)       (G_TYPE_INSTANCE_GET_CLASS ((obj), GTK_TYPE_MASKED_LABEL, GtkMaskedLabelClass))
+
+
+typedef struct _GtkMaskedLabel        GtkMaskedLabel;
+typedef struct _GtkMaskedLabelClass   GtkMaskedLabelClass;
+
+
+struct _GtkMaskedLabel
+{
+	GtkLabel label;
+};
+
+struct _GtkMaskedLabelClass
+{
+	GtkLabelClass parent_class;
+};
+
+
+GType gtk_masked_label_get_type (void) G_GNUC_CONST;
+
+GtkWidget *gtk_masked_label_new (const gchar *mask,
+                                 const gchar *text);
+
+void gtk_masked_label_set_mask (GtkMaskedLabel *masked_label,
+                                const gchar *mask);
+G_CONST_RETURN gchar *gtk_masked_label_get_mask (GtkMaskedLabel *masked_label);
+
+void gtk_masked_label_set_text (GtkMaskedLabel *masked_label,
+                                const gchar *text);
+G_CONST_RETURN gchar *gtk_masked_label_get_text (GtkMaskedLabel *masked_label);
+
+
+G_END_DECLS
+
+
+#endif /* __GTK_MASKED_LABEL_H__ */
@@ -0,0 +1,1641 @@
+/*
+ * MaskCore: the masks of GtkMaskedEntry without GTK+
+ * Copyright (C) 2005-2014 Andrea Zagli <azagli@libero.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+	#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "maskcore.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+	#define MASK_CORE_HAVE_SSE2 1
+	#include <emmintrin.h>
+	#if __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9) || defined(__clang__)
+		#define MASK_CORE_HAVE_AVX2 1
+		#include <immintrin.h>
+	#endif
+#endif
+
+typedef gint (*MaskCoreScanFunc) (const guint8 *classes,
+                                  const gchar *literals,
+                                  const gchar *text,
+                                  gint n);
+
+static void mask_core_classes_init (void);
+static gchar *mask_core_to_ascii (const gchar *mask);
+static gint mask_core_checksum_step (MaskCoreChecksum checksum,
+                                     gint n,
+                                     gint state,
+                                     gint i,
+                                     gchar c);
+static gboolean mask_core_checksum_valid (MaskCoreChecksum checksum,
+                                          gint state);
+static gint mask_core_scan (const guint8 *classes,
+                            const gchar *literals,
+                            const gchar *text,
+                            gint n);
+
+static void mask_core_free (MaskCore *mask);
+static void mask_core_set_build (MaskCoreSet *set);
+
+static MaskCoreScanFunc mask_core_scan_func = NULL;
+
+/*
+ * the alternative masks of a field, chosen by the first characters of its
+ * value: a trie of the prefixes, as a table of transitions indexed by node
+ * and by column, the columns being the characters used in the prefixes plus
+ * one for all the others
+ */
+struct _MaskCoreSet
+{
+	GPtrArray *prefixes;
+	GPtrArray *masks;
+
+	guint8 columns[256];
+	gint n_columns;
+	gint *next;
+	gint *node_mask;
+	gint n_nodes;
+	gint depth;
+
+	gint ref_count;
+};
+
+/* the check digits declared at the end of a mask, as "{luhn}" */
+static const struct
+{
+	const gchar *name;
+	MaskCoreChecksum checksum;
+} mask_core_checksums[] =
+{
+	{ "{luhn}", MASK_CORE_CHECKSUM_LUHN },
+	{ "{mod97}", MASK_CORE_CHECKSUM_MOD_97_10 },
+	{ "{iban}", MASK_CORE_CHECKSUM_IBAN },
+	{ "{mod11-2}", MASK_CORE_CHECKSUM_MOD_11_2 }
+};
+
+/* the interned masks, by text */
+static GHashTable *mask_core_registry = NULL;
+G_LOCK_DEFINE_STATIC (mask_core_registry);
+
+/* for every class, the character written for every character accepted,
+ * '\0' for those refused: checking and transforming a character is one
+ * lookup; the literals accept nothing. They are read without the lock: a
+ * row is filled before it is published, and never changed after */
+static gchar mask_core_class_table[256][256];
+static gint mask_core_n_classes = 0;
+
+/* the class of every character of a mask */
+static guint8 mask_core_class_of[256];
+G_LOCK_DEFINE_STATIC (mask_core_classes);
+
+static inline gboolean
+mask_core_class_accepts (guint8 klass, gchar c)
+{
+	return mask_core_class_table[klass][(guchar)c] != '\0';
+}
+
+static inline gchar
+mask_core_class_transform (guint8 klass, gchar c)
+{
+	return mask_core_class_table[klass][(guchar)c];
+}
+
+/* the classes of the mask characters built in, on ASCII */
+static void
+mask_core_classes_init (void)
+{
+	static gsize initialized = 0;
+	gint c;
+
+	if (g_once_init_enter (&initialized))
+		{
+			for (c = 1; c < 128; c++)
+				{
+					if (g_ascii_isdigit (c))
+						{
+							mask_core_class_table[MASK_CORE_CLASS_DIGIT][c] = c;
+							mask_core_class_table[MASK_CORE_CLASS_DIGIT_NOT_ZERO][c] = (c != '0' ? c : '\0');
+						}
+					if (g_ascii_isalpha (c))
+						{
+							mask_core_class_table[MASK_CORE_CLASS_ALPHA][c] = c;
+							mask_core_class_table[MASK_CORE_CLASS_ALPHA_UPPER][c] = g_ascii_toupper (c);
+						}
+					if (g_ascii_isalnum (c))
+						{
+							mask_core_class_table[MASK_CORE_CLASS_ALNUM][c] = c;
+						}
+				}
+
+			mask_core_class_of['0'] = MASK_CORE_CLASS_DIGIT;
+			mask_core_class_of['9'] = MASK_CORE_CLASS_DIGIT_NOT_ZERO;
+			mask_core_class_of['@'] = MASK_CORE_CLASS_ALPHA;
+			mask_core_class_of['^'] = MASK_CORE_CLASS_ALPHA_UPPER;
+			mask_core_class_of['#'] = MASK_CORE_CLASS_ALNUM;
+			mask_core_n_classes = MASK_CORE_CLASS_CUSTOM;
+
+			g_once_init_leave (&initialized, 1);
+		}
+}
+
+/**
+ * mask_core_register_class:
+ * @mask_char: the character standing for the class in masks.
+ * @accepted: the characters accepted, as single characters and ranges such
+ * as "A-F"; a '-' is taken as itself at the start and at the end.
+ * @transform: (allow-none): the function giving the character written for
+ * every character accepted, or %NULL to write them as they are.
+ *
+ * Adds a class of writeable characters to the ones built in, as "0-9A-Fa-f"
+ * for hexadecimal digits with g_ascii_toupper(). It is compiled into a table
+ * of 256 characters, used by #GtkMaskedEntry and #GtkCellRendererMasked as
+ * the classes built in are. Register a class before compiling the masks
+ * using it: masks compiled before, and interned, keep @mask_char as a
+ * literal. The tables are read without locking, so that registering must
+ * be done before other threads compile masks using @mask_char.
+ *
+ * As masks, classes are ASCII: other characters in @accepted, and the ones
+ * given by @transform, are left out.
+ *
+ * Returns: %FALSE if @mask_char already stands for a class, is not ASCII or
+ * is #MASK_CORE_PLACEHOLDER, or if there are no classes left.
+ */
+gboolean
+mask_core_register_class (gchar mask_char, const gchar *accepted, MaskCoreTransformFunc transform)
+{
+	const guchar *a;
+	gchar *row;
+	gint c;
+
+	g_return_val_if_fail (accepted != NULL, FALSE);
+
+	mask_core_classes_init ();
+
+	G_LOCK (mask_core_classes);
+
+	if (mask_char == '\0' || (guchar)mask_char >= 0x80 || mask_char == MASK_CORE_PLACEHOLDER
+	    || mask_core_class_of[(guchar)mask_char] != MASK_CORE_CLASS_LITERAL
+	    || mask_core_n_classes >= (gint)G_N_ELEMENTS (mask_core_class_table))
+		{
+			G_UNLOCK (mask_core_classes);
+			return FALSE;
+		}
+
+	row = mask_core_class_table[mask_core_n_classes];
+	for (a = (const guchar *)accepted; *a != '\0'; a++)
+		{
+			if (a[1] == '-' && a[2] != '\0')
+				{
+					for (c = a[0]; c <= a[2] && c < 0x80; c++)
+						{
+							row[c] = c;
+						}
+					a += 2;
+				}
+			else if (*a < 0x80)
+				{
+					row[*a] = *a;
+				}
+		}
+	if (transform != NULL)
+		{
+			for (c = 1; c < 0x80; c++)
+				{
+					if (row[c] != '\0')
+						{
+							/* a character out of ASCII is refused */
+							row[c] = transform (c);
+							if ((guchar)row[c] >= 0x80)
+								{
+									row[c] = '\0';
+								}
+						}
+				}
+		}
+
+	/* published once the row is filled */
+	mask_core_class_of[(guchar)mask_char] = mask_core_n_classes;
+	g_atomic_int_set (&mask_core_n_classes, mask_core_n_classes + 1);
+
+	G_UNLOCK (mask_core_classes);
+
+	return TRUE;
+}
+
+/**
+ * mask_core_get_n_classes:
+ *
+ * Returns: the number of classes, #MASK_CORE_CLASS_LITERAL and the ones
+ * registered with mask_core_register_class() included.
+ */
+guint
+mask_core_get_n_classes (void)
+{
+	mask_core_classes_init ();
+
+	return g_atomic_int_get (&mask_core_n_classes);
+}
+
+/**
+ * mask_core_class_lookup:
+ * @klass: a class, less than mask_core_get_n_classes().
+ * @c: a character.
+ *
+ * Returns: the character written for @c on the positions of class @klass,
+ * or '\0' if @c is refused there.
+ */
+gchar
+mask_core_class_lookup (guint8 klass, gchar c)
+{
+	mask_core_classes_init ();
+
+	return mask_core_class_transform (klass, c);
+}
+
+/* a copy of mask with every character out of ASCII replaced by '?', or
+ * NULL if it is all ASCII */
+static gchar
+*mask_core_to_ascii (const gchar *mask)
+{
+	const guchar *m;
+	GString *ascii;
+
+	for (m = (const guchar *)mask; *m != '\0' && *m < 0x80; m++);
+	if (*m == '\0')
+		{
+			return NULL;
+		}
+
+	ascii = g_string_new_len (mask, (const gchar *)m - mask);
+	while (*m != '\0')
+		{
+			if (*m < 0x80)
+				{
+					g_string_append_c (ascii, *m++);
+					continue;
+				}
+
+			/* the bytes following the first one of a character */
+			g_string_append_c (ascii, '?');
+			for (m++; (*m & 0xc0) == 0x80; m++);
+		}
+
+	return g_string_free (ascii, FALSE);
+}
+
+/**
+ * mask_core_compile:
+ * @mask: the mask.
+ *
+ * Compiles a mask. Characters in the mask are of two types:
+ *   writeable: writeable characters are characters that will be replaced with
+ *              underscores and where you can enter text.
+ *   fixed: every other characters are fixed characters, where you can't enter text.
+ * Possible values for writeable characters are:
+ *   '0': digits
+ *   '9': digits excluded 0
+ *   '@': alpha
+ *   '^': alpha converted to upper case
+ *   '#': alphanumeric
+ * and the characters of the classes added with mask_core_register_class().
+ * The mask can end with the check digits of the values, see
+ * #MaskCoreChecksum: "0000 0000 0000 0000{luhn}".
+ * Masks are ASCII: a position in the mask is a byte and a character of the
+ * text shown. Other characters are replaced by '?', with a warning.
+ *
+ * Returns: the compiled mask; free it with mask_core_unref().
+ */
+MaskCore
+*mask_core_compile (const gchar *mask)
+{
+	MaskCore *compiled;
+	gchar *ascii;
+	gint i, b, s, l;
+
+	if (mask == NULL)
+		{
+			mask = "";
+		}
+
+	mask_core_classes_init ();
+
+	compiled = g_new0 (MaskCore, 1);
+	compiled->ref_count = 1;
+	compiled->text = g_strdup (mask);
+
+	/* positions in the mask are bytes and characters at once */
+	ascii = mask_core_to_ascii (mask);
+	if (ascii != NULL)
+		{
+			g_warning ("Mask \"%s\": characters out of ASCII are not supported, they are shown as '?'.", mask);
+			mask = ascii;
+		}
+	compiled->length = strlen (mask);
+
+	for (i = 0; i < (gint)G_N_ELEMENTS (mask_core_checksums); i++)
+		{
+			l = strlen (mask_core_checksums[i].name);
+			if (compiled->length >= l
+			    && strcmp (mask + compiled->length - l, mask_core_checksums[i].name) == 0)
+				{
+					compiled->checksum = mask_core_checksums[i].checksum;
+					compiled->length -= l;
+					break;
+				}
+		}
+
+	compiled->literals = g_strndup (mask, compiled->length);
+	compiled->classes = g_new0 (guint8, compiled->length + 1);
+	compiled->writeable = g_new0 (guint32, (compiled->length >> 5) + 1);
+
+	for (i = 0; i < compiled->length; i++)
+		{
+			compiled->classes[i] = mask_core_class_of[(guchar)mask[i]];
+
+			if (compiled->classes[i] != MASK_CORE_CLASS_LITERAL)
+				{
+					compiled->writeable[i >> 5] |= 1u << (i & 31);
+					compiled->literals[i] = MASK_CORE_PLACEHOLDER;
+					compiled->n_writeable++;
+
+					if (i == 0 || compiled->classes[i - 1] == MASK_CORE_CLASS_LITERAL)
+						{
+							compiled->n_blocks++;
+						}
+				}
+		}
+
+	/* writeable positions and their blocks */
+	compiled->slots = g_new (gint, compiled->n_writeable + 1);
+	compiled->slot_classes = g_new (guint8, compiled->n_writeable + 1);
+	compiled->slot_at = g_new (gint, compiled->length + 1);
+	compiled->blocks = g_new (MaskCoreBlock, compiled->n_blocks + 1);
+	for (i = 0, b = -1, s = 0; i < compiled->length; i++)
+		{
+			compiled->slot_at[i] = s;
+			if (MASK_CORE_IS_WRITEABLE (compiled, i))
+				{
+					compiled->slot_classes[s] = compiled->classes[i];
+					compiled->slots[s++] = i;
+
+					if (i == 0 || !MASK_CORE_IS_WRITEABLE (compiled, i - 1))
+						{
+							compiled->blocks[++b].start = i;
+						}
+					compiled->blocks[b].end = i + 1;
+				}
+		}
+	compiled->slot_at[compiled->length] = s;
+
+	/* tab and shift-tab targets: from inside a block they are the following
+	 * and the preceding blocks, from a literal the blocks around it */
+	compiled->block_at = g_new (gint, compiled->length + 1);
+	compiled->next_block = g_new (gint, compiled->length + 1);
+	compiled->prev_block = g_new (gint, compiled->length + 1);
+	for (i = 0, b = 0; i <= compiled->length; i++)
+		{
+			while (b < compiled->n_blocks && compiled->blocks[b].end <= i)
+				{
+					b++;
+				}
+
+			if (b < compiled->n_blocks && compiled->blocks[b].start <= i)
+				{
+					compiled->block_at[i] = b;
+					compiled->next_block[i] = (b + 1 < compiled->n_blocks ? compiled->blocks[b + 1].start : -1);
+				}
+			else
+				{
+					compiled->block_at[i] = -1;
+					compiled->next_block[i] = (b < compiled->n_blocks ? compiled->blocks[b].start : -1);
+				}
+			compiled->prev_block[i] = (b > 0 ? compiled->blocks[b - 1].start : -1);
+		}
+
+	g_free (ascii);
+
+	return compiled;
+}
+
+/**
+ * mask_core_intern:
+ * @mask: the mask.
+ *
+ * Gets the compiled mask shared by everyone using the same @mask, compiling
+ * it only the first time: widgets with the same mask all point to one
+ * #MaskCore. It stays in the registry as long as it is referenced.
+ *
+ * Returns: the compiled mask; free it with mask_core_unref().
+ */
+MaskCore
+*mask_core_intern (const gchar *mask)
+{
+	MaskCore *compiled;
+
+	if (mask == NULL)
+		{
+			mask = "";
+		}
+
+	G_LOCK (mask_core_registry);
+
+	if (mask_core_registry == NULL)
+		{
+			mask_core_registry = g_hash_table_new (g_str_hash, g_str_equal);
+		}
+
+	compiled = g_hash_table_lookup (mask_core_registry, mask);
+	if (compiled != NULL)
+		{
+			g_atomic_int_inc (&compiled->ref_count);
+		}
+	else
+		{
+			compiled = mask_core_compile (mask);
+			compiled->interned = TRUE;
+			g_hash_table_insert (mask_core_registry, compiled->text, compiled);
+		}
+
+	G_UNLOCK (mask_core_registry);
+
+	return compiled;
+}
+
+/**
+ * mask_core_ref:
+ * @mask: a #MaskCore.
+ *
+ * Returns: @mask, with its reference count increased.
+ */
+MaskCore
+*mask_core_ref (MaskCore *mask)
+{
+	g_return_val_if_fail (mask != NULL, NULL);
+
+	g_atomic_int_inc (&mask->ref_count);
+
+	return mask;
+}
+
+/**
+ * mask_core_unref:
+ * @mask: a #MaskCore.
+ *
+ * Decreases the reference count of @mask, freeing it when it drops to 0.
+ */
+void
+mask_core_unref (MaskCore *mask)
+{
+	if (mask == NULL)
+		{
+			return;
+		}
+
+	if (mask->interned)
+		{
+			gboolean last;
+
+			/* under the lock, so that mask_core_intern() does not find it
+			 * once its last reference is gone */
+			G_LOCK (mask_core_registry);
+			last = g_atomic_int_dec_and_test (&mask->ref_count);
+			if (last)
+				{
+					g_hash_table_remove (mask_core_registry, mask->text);
+				}
+			G_UNLOCK (mask_core_registry);
+
+			if (last)
+				{
+					mask_core_free (mask);
+				}
+		}
+	else if (g_atomic_int_dec_and_test (&mask->ref_count))
+		{
+			mask_core_free (mask);
+		}
+}
+
+/**
+ * mask_core_accept:
+ * @mask: a #MaskCore.
+ * @position: a position in the mask.
+ * @c: a character.
+ * @accepted: where to store the character as it must be written; it is left
+ * untouched if @c is refused.
+ *
+ * Returns: whether @c can be written at @position.
+ */
+gboolean
+mask_core_accept (const MaskCore *mask, gint position, gchar c, gchar *accepted)
+{
+	if (mask_core_class_accepts (mask->classes[position], c))
+		{
+			*accepted = mask_core_class_transform (mask->classes[position], c);
+			return TRUE;
+		}
+
+	return FALSE;
+}
+
+/**
+ * mask_core_get_first_writeable:
+ * @mask: a #MaskCore.
+ * @position: a position in the mask.
+ *
+ * Returns: the first writeable position from @position onwards, or the length
+ * of the mask.
+ */
+gint
+mask_core_get_first_writeable (const MaskCore *mask, gint position)
+{
+	gint s;
+
+	if (position >= mask->length)
+		{
+			return mask->length;
+		}
+
+	/* one lookup: slot_at holds the first writeable position from there */
+	s = mask->slot_at[MAX (position, 0)];
+
+	return (s < mask->n_writeable ? mask->slots[s] : mask->length);
+}
+
+/**
+ * mask_core_validate:
+ * @mask: a #MaskCore.
+ * @raw: a value without the mask.
+ * @length: the length of @raw in bytes, or -1 if it is nul-terminated.
+ *
+ * Checks every character of @raw against the writeable position of the mask
+ * it would fill.
+ *
+ * Returns: -1 if @raw fits the mask, otherwise the index of the first
+ * character refused.
+ */
+gint
+mask_core_validate (const MaskCore *mask, const gchar *raw, gssize length)
+{
+	gint ret;
+
+	if (length < 0)
+		{
+			length = strlen (raw);
+		}
+
+	ret = mask_core_scan (mask->slot_classes, NULL, raw, MIN (length, mask->n_writeable));
+	if (ret < 0 && length > mask->n_writeable)
+		{
+			ret = mask->n_writeable;
+		}
+
+	return ret;
+}
+
+/**
+ * mask_core_validate_formatted:
+ * @mask: a #MaskCore.
+ * @text: a value with the mask.
+ * @length: the length of @text in bytes, or -1 if it is nul-terminated.
+ *
+ * Checks that @text is a complete value with the mask: every literal in
+ * place and every writeable position filled with a character accepted.
+ *
+ * Returns: -1 if @text is valid, otherwise the first position that is not.
+ */
+gint
+mask_core_validate_formatted (const MaskCore *mask, const gchar *text, gssize length)
+{
+	gint ret;
+
+	if (length < 0)
+		{
+			length = strlen (text);
+		}
+
+	ret = mask_core_scan (mask->classes, mask->literals, text, MIN (length, mask->length));
+	if (ret < 0 && length != mask->length)
+		{
+			ret = MIN (length, mask->length);
+		}
+
+	return ret;
+}
+
+/**
+ * mask_core_format:
+ * @mask: a #MaskCore.
+ * @raw: a value without the mask.
+ * @length: the length of @raw in bytes, or -1 if it is nul-terminated.
+ * @buffer: where to write the value with the mask; it must hold the length
+ * of the mask plus one bytes.
+ *
+ * Writes the characters of @raw on the writeable positions of the mask, as
+ * #GtkMaskedEntry displays them, stopping at the first character refused.
+ *
+ * Returns: the number of characters of @raw written.
+ */
+gint
+mask_core_format (const MaskCore *mask, const gchar *raw, gssize length, gchar *buffer)
+{
+	gint i, n;
+
+	if (length < 0)
+		{
+			length = strlen (raw);
+		}
+
+	memcpy (buffer, mask->literals, mask->length + 1);
+
+	n = MIN (length, mask->n_writeable);
+	i = mask_core_scan (mask->slot_classes, NULL, raw, n);
+	if (i > -1)
+		{
+			n = i;
+		}
+
+	for (i = 0; i < n; i++)
+		{
+			buffer[mask->slots[i]] = mask_core_class_transform (mask->slot_classes[i], raw[i]);
+		}
+
+	return n;
+}
+
+/**
+ * mask_core_unformat:
+ * @mask: a #MaskCore.
+ * @text: a value with the mask.
+ * @length: the length of @text in bytes, or -1 if it is nul-terminated.
+ * @buffer: where to write the value without the mask; it must hold the
+ * number of writeable positions plus one bytes.
+ *
+ * Extracts the characters written on the writeable positions of the mask,
+ * as gtk_masked_entry_get_text() does.
+ *
+ * Returns: the length of the value written in @buffer.
+ */
+gint
+mask_core_unformat (const MaskCore *mask, const gchar *text, gssize length, gchar *buffer)
+{
+	gint i, c = 0;
+
+	if (length < 0)
+		{
+			length = strlen (text);
+		}
+
+	for (i = 0; i < mask->n_writeable && mask->slots[i] < length; i++)
+		{
+			if (text[mask->slots[i]] != MASK_CORE_PLACEHOLDER)
+				{
+					buffer[c++] = text[mask->slots[i]];
+				}
+		}
+	buffer[c] = '\0';
+
+	return c;
+}
+
+/**
+ * mask_core_format_slots:
+ * @mask: a #MaskCore.
+ * @slots: the characters of the writeable positions of a value, empty ones
+ * as #MASK_CORE_PLACEHOLDER, see gtk_masked_entry_buffer_get_slots().
+ * @length: the length of @slots in bytes, or -1 if it is nul-terminated.
+ * @buffer: where to write the value with the mask; it must hold the length
+ * of the mask plus one bytes.
+ *
+ * Writes every character of @slots on the writeable position of the same
+ * index of @mask: unlike mask_core_format(), the empty positions stay where
+ * they are, and a character refused leaves its position empty.
+ *
+ * Returns: the number of writeable positions filled.
+ */
+gint
+mask_core_format_slots (const MaskCore *mask, const gchar *slots, gssize length, gchar *buffer)
+{
+	gint i, n, c = 0;
+
+	if (length < 0)
+		{
+			length = strlen (slots);
+		}
+
+	memcpy (buffer, mask->literals, mask->length + 1);
+
+	n = MIN (length, mask->n_writeable);
+	for (i = 0; i < n; i++)
+		{
+			if (slots[i] != MASK_CORE_PLACEHOLDER
+			    && mask_core_class_accepts (mask->slot_classes[i], slots[i]))
+				{
+					buffer[mask->slots[i]] = mask_core_class_transform (mask->slot_classes[i], slots[i]);
+					c++;
+				}
+		}
+
+	return c;
+}
+
+/**
+ * mask_core_format_batch:
+ * @mask: a #MaskCore.
+ * @raws: an array of @n nul-terminated values without the mask.
+ * @n: the number of values.
+ * @arena: where to write the values with the mask; it must hold
+ * @n * MASK_CORE_FORMATTED_SIZE(@mask) bytes.
+ *
+ * Formats many values as mask_core_format() does, one after the other:
+ * the value of index i is written at @arena + i * MASK_CORE_FORMATTED_SIZE(@mask).
+ *
+ * Returns: the number of values written entirely.
+ */
+guint
+mask_core_format_batch (const MaskCore *mask, const gchar * const *raws, guint n, gchar *arena)
+{
+	guint i, ret = 0;
+	gsize l;
+
+	for (i = 0; i < n; i++, arena += MASK_CORE_FORMATTED_SIZE (mask))
+		{
+			l = strlen (raws[i]);
+			if ((gsize)mask_core_format (mask, raws[i], l, arena) == l)
+				{
+					ret++;
+				}
+		}
+
+	return ret;
+}
+
+/**
+ * mask_core_format_packed:
+ * @mask: a #MaskCore.
+ * @packed: the values without the mask, one after the other.
+ * @offsets: @n + 1 offsets in @packed: the value of index i goes from
+ * @offsets[i] to @offsets[i + 1].
+ * @n: the number of values.
+ * @arena: where to write the values with the mask; it must hold
+ * @n * MASK_CORE_FORMATTED_SIZE(@mask) bytes.
+ *
+ * As mask_core_format_batch(), but with the values packed in one buffer.
+ *
+ * Returns: the number of values written entirely.
+ */
+guint
+mask_core_format_packed (const MaskCore *mask, const gchar *packed, const gsize *offsets, guint n, gchar *arena)
+{
+	guint i, ret = 0;
+	gsize l;
+
+	for (i = 0; i < n; i++, arena += MASK_CORE_FORMATTED_SIZE (mask))
+		{
+			l = offsets[i + 1] - offsets[i];
+			if ((gsize)mask_core_format (mask, packed + offsets[i], l, arena) == l)
+				{
+					ret++;
+				}
+		}
+
+	return ret;
+}
+
+/**
+ * mask_core_unformat_batch:
+ * @mask: a #MaskCore.
+ * @texts: an array of @n nul-terminated values with the mask.
+ * @n: the number of values.
+ * @arena: where to write the values without the mask; it must hold
+ * @n * MASK_CORE_UNFORMATTED_SIZE(@mask) bytes.
+ *
+ * Unformats many values as mask_core_unformat() does, one after the other:
+ * the value of index i is written at @arena + i * MASK_CORE_UNFORMATTED_SIZE(@mask).
+ */
+void
+mask_core_unformat_batch (const MaskCore *mask, const gchar * const *texts, guint n, gchar *arena)
+{
+	guint i;
+
+	for (i = 0; i < n; i++, arena += MASK_CORE_UNFORMATTED_SIZE (mask))
+		{
+			mask_core_unformat (mask, texts[i], -1, arena);
+		}
+}
+
+/**
+ * mask_core_insert:
+ * @mask: a #MaskCore.
+ * @text: the text to insert.
+ * @length: the length of @text in bytes, or -1 if it is nul-terminated.
+ * @position: the position where to insert; it is moved to the first writeable
+ * position from there.
+ * @buffer: where to write the text replacing the one from @position; it must
+ * hold the length of the mask plus one bytes.
+ *
+ * Computes what inserting @text at @position writes on a text with the mask,
+ * in one pass over @text. The characters of @text fill the writeable
+ * positions the mask accepts them on, transformed; the literals of the mask
+ * are written on the way, taking the same character from @text if it is
+ * there. Punctuation and spaces in @text that no literal takes are skipped,
+ * so that a value is inserted the same with or without the mask, and with
+ * other separators. The insertion stops at the first other character
+ * refused, or at the end of the mask.
+ *
+ * Returns: the number of characters written in @buffer, that replace as many
+ * characters from @position.
+ */
+gint
+mask_core_insert (const MaskCore *mask, const gchar *text, gssize length, gint *position, gchar *buffer)
+{
+	gint i, p, start, n;
+
+	if (length < 0)
+		{
+			length = strlen (text);
+		}
+
+	if (mask->length == 0 || *position < 0 || *position >= mask->length)
+		{
+			return 0;
+		}
+
+	/* get first available position that it is a writeable mask char */
+	*position = mask_core_get_first_writeable (mask, *position);
+	start = *position;
+
+	/* as long as the text is lined up with the mask, as a value pasted with
+	 * the mask, the kernel checks its literals too */
+	n = MIN (length, mask->length - start);
+	i = mask_core_scan (mask->classes + start, mask->literals + start, text, n);
+	if (i < 0)
+		{
+			i = n;
+		}
+	for (p = 0; p < i; p++)
+		{
+			buffer[p] = (mask->classes[start + p] == MASK_CORE_CLASS_LITERAL
+			             ? text[p]
+			             : mask_core_class_transform (mask->classes[start + p], text[p]));
+		}
+	p = start + i;
+
+	/* from the first character out of line */
+	while (i < length && p < mask->length)
+		{
+			if (!MASK_CORE_IS_WRITEABLE (mask, p))
+				{
+					if (text[i] == mask->literals[p])
+						{
+							i++;
+						}
+					buffer[p - start] = mask->literals[p];
+					p++;
+				}
+			else if (mask_core_class_accepts (mask->classes[p], text[i]))
+				{
+					buffer[p - start] = mask_core_class_transform (mask->classes[p], text[i]);
+					i++;
+					p++;
+				}
+			else if (g_ascii_ispunct (text[i]) || g_ascii_isspace (text[i]))
+				{
+					i++;
+				}
+			else
+				{
+					break;
+				}
+		}
+	buffer[p - start] = '\0';
+
+	return p - start;
+}
+
+/**
+ * mask_core_erase:
+ * @mask: a #MaskCore.
+ * @start_pos: the first position to erase.
+ * @end_pos: the position following the last one to erase, or -1 for the end
+ * of the mask; it is moved inside the mask.
+ *
+ * Returns: the empty mask replacing the text from @start_pos to @end_pos, or
+ * %NULL if the range is not valid.
+ */
+const gchar
+*mask_core_erase (const MaskCore *mask, gint *start_pos, gint *end_pos)
+{
+	if (*end_pos < 0 || *end_pos > mask->length)
+		{
+			*end_pos = mask->length;
+		}
+	if (*start_pos < 0 || *start_pos > *end_pos)
+		{
+			return NULL;
+		}
+
+	return mask->literals + *start_pos;
+}
+
+/**
+ * mask_core_apply_keystroke:
+ * @mask: a #MaskCore.
+ * @text: a value with the mask, modified in place.
+ * @position: the cursor position.
+ * @c: the character typed.
+ *
+ * Applies to @text a keystroke as #GtkMaskedEntry does.
+ *
+ * Returns: the new cursor position, or -1 if @c was refused.
+ */
+gint
+mask_core_apply_keystroke (const MaskCore *mask, gchar *text, gint position, gchar c)
+{
+	if (position < 0)
+		{
+			return -1;
+		}
+
+	position = mask_core_get_first_writeable (mask, position);
+	if (position >= mask->length
+	    || !mask_core_accept (mask, position, c, &text[position]))
+		{
+			return -1;
+		}
+
+	return position + 1;
+}
+
+/**
+ * mask_core_check_step:
+ * @mask: a #MaskCore.
+ * @state: the state of the check digits before @slot, #MASK_CORE_CHECK_INIT
+ * before the first one.
+ * @slot: the index of a writeable position.
+ * @c: the character of @slot.
+ *
+ * Runs the check digits of the mask over one more character, so that they
+ * are kept along a value as it is typed: the state after every slot depends
+ * only on the state before it and on its character, and a change leaves
+ * the states before it good.
+ *
+ * Returns: the state after @slot; it is negative once a character cannot
+ * be in the value.
+ */
+gint
+mask_core_check_step (const MaskCore *mask, gint state, gint slot, gchar c)
+{
+	return mask_core_checksum_step (mask->checksum, mask->n_writeable, state, slot, c);
+}
+
+/**
+ * mask_core_check_finish:
+ * @mask: a #MaskCore.
+ * @state: the state of the check digits after the last slot.
+ *
+ * Returns: whether the check digits of a complete value, whose state is
+ * @state, are right; always %TRUE for masks without check digits.
+ */
+gboolean
+mask_core_check_finish (const MaskCore *mask, gint state)
+{
+	return mask_core_checksum_valid (mask->checksum, state);
+}
+
+/**
+ * mask_core_check:
+ * @mask: a #MaskCore.
+ * @raw: a value without the mask.
+ * @length: the length of @raw in bytes, or -1 if it is nul-terminated.
+ *
+ * Checks that @raw is a complete value for the mask: it fills all the
+ * writeable positions with characters accepted, and its check digits are
+ * right.
+ *
+ * Returns: whether @raw is valid.
+ */
+gboolean
+mask_core_check (const MaskCore *mask, const gchar *raw, gssize length)
+{
+	gint i, state;
+
+	if (length < 0)
+		{
+			length = strlen (raw);
+		}
+
+	if (length != mask->n_writeable || mask_core_scan (mask->slot_classes, NULL, raw, length) > -1)
+		{
+			return FALSE;
+		}
+	if (mask->checksum == MASK_CORE_CHECKSUM_NONE)
+		{
+			return TRUE;
+		}
+
+	state = MASK_CORE_CHECK_INIT;
+	for (i = 0; i < length && state >= 0; i++)
+		{
+			state = mask_core_checksum_step (mask->checksum, length, state, i, raw[i]);
+		}
+
+	return mask_core_checksum_valid (mask->checksum, state);
+}
+
+/**
+ * mask_core_check_batch:
+ * @mask: a #MaskCore.
+ * @raws: an array of @n nul-terminated values without the mask.
+ * @n: the number of values.
+ * @valid: (allow-none): where to store whether every value is valid, or
+ * %NULL.
+ *
+ * Checks many values as mask_core_check() does, as the records imported.
+ *
+ * Returns: the number of values valid.
+ */
+guint
+mask_core_check_batch (const MaskCore *mask, const gchar * const *raws, guint n, gboolean *valid)
+{
+	guint i, ret = 0;
+	gboolean ok;
+
+	for (i = 0; i < n; i++)
+		{
+			ok = mask_core_check (mask, raws[i], -1);
+			if (valid != NULL)
+				{
+					valid[i] = ok;
+				}
+			ret += ok;
+		}
+
+	return ret;
+}
+
+/**
+ * mask_core_checksum_verify:
+ * @checksum: a #MaskCoreChecksum.
+ * @value: a value, without any separator.
+ * @length: the length of @value in bytes, or -1 if it is nul-terminated.
+ *
+ * Checks the check digits of @value, without a mask.
+ *
+ * Returns: whether the check digits of @value are right.
+ */
+gboolean
+mask_core_checksum_verify (MaskCoreChecksum checksum, const gchar *value, gssize length)
+{
+	gint i, state = MASK_CORE_CHECK_INIT;
+
+	if (length < 0)
+		{
+			length = strlen (value);
+		}
+
+	for (i = 0; i < length && state >= 0; i++)
+		{
+			state = mask_core_checksum_step (checksum, length, state, i, value[i]);
+		}
+
+	return mask_core_checksum_valid (checksum, state);
+}
+
+/**
+ * mask_core_set_new:
+ *
+ * Creates an empty set of alternative masks, see mask_core_set_add().
+ *
+ * Returns: the new #MaskCoreSet; free it with mask_core_set_unref().
+ */
+MaskCoreSet
+*mask_core_set_new (void)
+{
+	MaskCoreSet *set = g_new0 (MaskCoreSet, 1);
+
+	set->prefixes = g_ptr_array_new_with_free_func (g_free);
+	set->masks = g_ptr_array_new_with_free_func ((GDestroyNotify)mask_core_unref);
+	set->ref_count = 1;
+	mask_core_set_build (set);
+
+	return set;
+}
+
+/**
+ * mask_core_set_ref:
+ * @set: a #MaskCoreSet.
+ *
+ * Returns: @set, with its reference count increased.
+ */
+MaskCoreSet
+*mask_core_set_ref (MaskCoreSet *set)
+{
+	g_return_val_if_fail (set != NULL, NULL);
+
+	g_atomic_int_inc (&set->ref_count);
+
+	return set;
+}
+
+/**
+ * mask_core_set_unref:
+ * @set: a #MaskCoreSet.
+ *
+ * Decreases the reference count of @set, freeing it when it drops to 0.
+ */
+void
+mask_core_set_unref (MaskCoreSet *set)
+{
+	if (set == NULL || !g_atomic_int_dec_and_test (&set->ref_count))
+		{
+			return;
+		}
+
+	g_ptr_array_free (set->prefixes, TRUE);
+	g_ptr_array_free (set->masks, TRUE);
+	g_free (set->next);
+	g_free (set->node_mask);
+	g_free (set);
+}
+
+/**
+ * mask_core_set_add:
+ * @set: a #MaskCoreSet.
+ * @prefix: the first characters of the values, without the mask, taking
+ * @mask; "" for the mask of the values no other prefix matches.
+ * @mask: the mask.
+ *
+ * Registers @mask for the values starting with @prefix, replacing the mask
+ * registered before for the same @prefix. The longest prefix matching a
+ * value wins; without a mask for "", the first mask added is the one of the
+ * values no prefix matches.
+ */
+void
+mask_core_set_add (MaskCoreSet *set, const gchar *prefix, const gchar *mask)
+{
+	guint i;
+
+	g_return_if_fail (set != NULL);
+
+	if (prefix == NULL)
+		{
+			prefix = "";
+		}
+
+	for (i = 0; i < set->prefixes->len; i++)
+		{
+			if (strcmp (g_ptr_array_index (set->prefixes, i), prefix) == 0)
+				{
+					mask_core_unref (g_ptr_array_index (set->masks, i));
+					g_ptr_array_index (set->masks, i) = mask_core_intern (mask);
+					mask_core_set_build (set);
+					return;
+				}
+		}
+
+	g_ptr_array_add (set->prefixes, g_strdup (prefix));
+	g_ptr_array_add (set->masks, mask_core_intern (mask));
+	mask_core_set_build (set);
+}
+
+/**
+ * mask_core_set_lookup:
+ * @set: a #MaskCoreSet.
+ * @raw: a value without the mask.
+ * @length: the length of @raw in bytes, or -1 if it is nul-terminated.
+ *
+ * Chooses the mask of @raw. At most as many characters of @raw as the
+ * longest prefix are read, one table lookup each: the cost does not depend
+ * on the number of masks in @set.
+ *
+ * Returns: the mask registered for the longest prefix of @raw, owned by
+ * @set, or %NULL if @set is empty.
+ */
+MaskCore
+*mask_core_set_lookup (const MaskCoreSet *set, const gchar *raw, gssize length)
+{
+	gint i, node, next;
+
+	if (set->masks->len == 0)
+		{
+			return NULL;
+		}
+
+	node = 0;
+	for (i = 0; i < set->depth && (length < 0 ? raw[i] != '\0' : i < length); i++)
+		{
+			next = set->next[node * set->n_columns + set->columns[(guchar)raw[i]]];
+			if (next == 0)
+				{
+					break;
+				}
+			node = next;
+		}
+
+	return g_ptr_array_index (set->masks, set->node_mask[node]);
+}
+
+/*
+ * classification kernels: they check every character of text against the
+ * class at the same index, a literal accepts any character if literals is
+ * NULL and only itself otherwise, and return the index of the first
+ * character refused or -1
+ */
+static gint
+mask_core_scan_scalar (const guint8 *classes, const gchar *literals, const gchar *text, gint n)
+{
+	gint i;
+
+	for (i = 0; i < n; i++)
+		{
+			if (classes[i] == MASK_CORE_CLASS_LITERAL)
+				{
+					if (literals != NULL && text[i] != literals[i])
+						{
+							return i;
+						}
+				}
+			else if (!mask_core_class_accepts (classes[i], text[i]))
+				{
+					return i;
+				}
+		}
+
+	return -1;
+}
+
+#ifdef MASK_CORE_HAVE_SSE2
+/* 16 characters at a time; chunks with bytes out of ASCII, or with classes
+ * registered with mask_core_register_class(), are left to the scalar kernel */
+static gint
+mask_core_scan_sse2 (const guint8 *classes, const gchar *literals, const gchar *text, gint n)
+{
+	const __m128i before_0 = _mm_set1_epi8 ('0' - 1);
+	const __m128i after_9 = _mm_set1_epi8 ('9' + 1);
+	const __m128i zero = _mm_set1_epi8 ('0');
+	const __m128i before_a = _mm_set1_epi8 ('a' - 1);
+	const __m128i after_z = _mm_set1_epi8 ('z' + 1);
+	const __m128i lower_case = _mm_set1_epi8 (0x20);
+	const __m128i class_literal = _mm_set1_epi8 (MASK_CORE_CLASS_LITERAL);
+	const __m128i class_digit = _mm_set1_epi8 (MASK_CORE_CLASS_DIGIT);
+	const __m128i class_digit_not_zero = _mm_set1_epi8 (MASK_CORE_CLASS_DIGIT_NOT_ZERO);
+	const __m128i class_alpha = _mm_set1_epi8 (MASK_CORE_CLASS_ALPHA);
+	const __m128i class_alpha_upper = _mm_set1_epi8 (MASK_CORE_CLASS_ALPHA_UPPER);
+	const __m128i class_alnum = _mm_set1_epi8 (MASK_CORE_CLASS_ALNUM);
+	const __m128i class_custom = _mm_set1_epi8 (MASK_CORE_CLASS_CUSTOM);
+
+	__m128i t, k, custom, digit, alpha, lower, ok;
+	guint refused;
+	gint i, ret;
+
+	for (i = 0; i + 16 <= n; i += 16)
+		{
+			t = _mm_loadu_si128 ((const __m128i *)(text + i));
+			k = _mm_loadu_si128 ((const __m128i *)(classes + i));
+			custom = _mm_cmpeq_epi8 (_mm_max_epu8 (k, class_custom), k);
+
+			if (_mm_movemask_epi8 (_mm_or_si128 (t, custom)) != 0)
+				{
+					ret = mask_core_scan_scalar (classes + i, literals != NULL ? literals + i : NULL, text + i, 16);
+					if (ret > -1)
+						{
+							return i + ret;
+						}
+					continue;
+				}
+
+			digit = _mm_and_si128 (_mm_cmpgt_epi8 (t, before_0), _mm_cmpgt_epi8 (after_9, t));
+			lower = _mm_or_si128 (t, lower_case);
+			alpha = _mm_and_si128 (_mm_cmpgt_epi8 (lower, before_a), _mm_cmpgt_epi8 (after_z, lower));
+
+			ok = _mm_cmpeq_epi8 (k, class_literal);
+			if (literals != NULL)
+				{
+					ok = _mm_and_si128 (ok, _mm_cmpeq_epi8 (t, _mm_loadu_si128 ((const __m128i *)(literals + i))));
+				}
+			ok = _mm_or_si128 (ok, _mm_and_si128 (_mm_cmpeq_epi8 (k, class_digit), digit));
+			ok = _mm_or_si128 (ok, _mm_and_si128 (_mm_cmpeq_epi8 (k, class_digit_not_zero),
+			                                      _mm_andnot_si128 (_mm_cmpeq_epi8 (t, zero), digit)));
+			ok = _mm_or_si128 (ok, _mm_and_si128 (_mm_or_si128 (_mm_cmpeq_epi8 (k, class_alpha),
+			                                                    _mm_cmpeq_epi8 (k, class_alpha_upper)),
+			                                      alpha));
+			ok = _mm_or_si128 (ok, _mm_and_si128 (_mm_cmpeq_epi8 (k, class_alnum), _mm_or_si128 (digit, alpha)));
+
+			refused = ~(guint)_mm_movemask_epi8 (ok) & 0xffff;
+			if (refused != 0)
+				{
+					return i + __builtin_ctz (refused);
+				}
+		}
+
+	ret = mask_core_scan_scalar (classes + i, literals != NULL ? literals + i : NULL, text + i, n - i);
+
+	return (ret > -1 ? i + ret : -1);
+}
+#endif
+
+#ifdef MASK_CORE_HAVE_AVX2
+/* as mask_core_scan_sse2(), 32 characters at a time */
+__attribute__ ((target ("avx2"))) static gint
+mask_core_scan_avx2 (const guint8 *classes, const gchar *literals, const gchar *text, gint n)
+{
+	const __m256i before_0 = _mm256_set1_epi8 ('0' - 1);
+	const __m256i after_9 = _mm256_set1_epi8 ('9' + 1);
+	const __m256i zero = _mm256_set1_epi8 ('0');
+	const __m256i before_a = _mm256_set1_epi8 ('a' - 1);
+	const __m256i after_z = _mm256_set1_epi8 ('z' + 1);
+	const __m256i lower_case = _mm256_set1_epi8 (0x20);
+	const __m256i class_literal = _mm256_set1_epi8 (MASK_CORE_CLASS_LITERAL);
+	const __m256i class_digit = _mm256_set1_epi8 (MASK_CORE_CLASS_DIGIT);
+	const __m256i class_digit_not_zero = _mm256_set1_epi8 (MASK_CORE_CLASS_DIGIT_NOT_ZERO);
+	const __m256i class_alpha = _mm256_set1_epi8 (MASK_CORE_CLASS_ALPHA);
+	const __m256i class_alpha_upper = _mm256_set1_epi8 (MASK_CORE_CLASS_ALPHA_UPPER);
+	const __m256i class_alnum = _mm256_set1_epi8 (MASK_CORE_CLASS_ALNUM);
+	const __m256i class_custom = _mm256_set1_epi8 (MASK_CORE_CLASS_CUSTOM);
+
+	__m256i t, k, custom, digit, alpha, lower, ok;
+	guint refused;
+	gint i, ret;
+
+	for (i = 0; i + 32 <= n; i += 32)
+		{
+			t = _mm256_loadu_si256 ((const __m256i *)(text + i));
+			k = _mm256_loadu_si256 ((const __m256i *)(classes + i));
+			custom = _mm256_cmpeq_epi8 (_mm256_max_epu8 (k, class_custom), k);
+
+			if (_mm256_movemask_epi8 (_mm256_or_si256 (t, custom)) != 0)
+				{
+					ret = mask_core_scan_scalar (classes + i, literals != NULL ? literals + i : NULL, text + i, 32);
+					if (ret > -1)
+						{
+							return i + ret;
+						}
+					continue;
+				}
+
+			digit = _mm256_and_si256 (_mm256_cmpgt_epi8 (t, before_0), _mm256_cmpgt_epi8 (after_9, t));
+			lower = _mm256_or_si256 (t, lower_case);
+			alpha = _mm256_and_si256 (_mm256_cmpgt_epi8 (lower, before_a), _mm256_cmpgt_epi8 (after_z, lower));
+
+			ok = _mm256_cmpeq_epi8 (k, class_literal);
+			if (literals != NULL)
+				{
+					ok = _mm256_and_si256 (ok, _mm256_cmpeq_epi8 (t, _mm256_loadu_si256 ((const __m256i *)(literals + i))));
+				}
+			ok = _mm256_or_si256 (ok, _mm256_and_si256 (_mm256_cmpeq_epi8 (k, class_digit), digit));
+			ok = _mm256_or_si256 (ok, _mm256_and_si256 (_mm256_cmpeq_epi8 (k, class_digit_not_zero),
+			                                            _mm256_andnot_si256 (_mm256_cmpeq_epi8 (t, zero), digit)));
+			ok = _mm256_or_si256 (ok, _mm256_and_si256 (_mm256_or_si256 (_mm256_cmpeq_epi8 (k, class_alpha),
+			                                                             _mm256_cmpeq_epi8 (k, class_alpha_upper)),
+			                                            alpha));
+			ok = _mm256_or_si256 (ok, _mm256_and_si256 (_mm256_cmpeq_epi8 (k, class_alnum), _mm256_or_si256 (digit, alpha)));
+
+			refused = ~(guint)_mm256_movemask_epi8 (ok);
+			if (refused != 0)
+				{
+					return i + __builtin_ctz (refused);
+				}
+		}
+
+	ret = mask_core_scan_sse2 (classes + i, literals != NULL ? literals + i : NULL, text + i, n - i);
+
+	return (ret > -1 ? i + ret : -1);
+}
+#endif
+
+static gint
+mask_core_scan (const guint8 *classes, const gchar *literals, const gchar *text, gint n)
+{
+	/* the kernel is chosen once, on the first call, from what the CPU supports */
+	if (G_UNLIKELY (mask_core_scan_func == NULL))
+		{
+#if defined(MASK_CORE_HAVE_AVX2)
+			__builtin_cpu_init ();
+			mask_core_scan_func = (__builtin_cpu_supports ("avx2") ? mask_core_scan_avx2 : mask_core_scan_sse2);
+#elif defined(MASK_CORE_HAVE_SSE2)
+			mask_core_scan_func = mask_core_scan_sse2;
+#else
+			mask_core_scan_func = mask_core_scan_scalar;
+#endif
+		}
+
+	return mask_core_scan_func (classes, literals, text, n);
+}
+
+/*
+ * the check digits, run from left to right over the n characters of a
+ * value: the state after character i depends on the state before it, on i
+ * and on the character; -1 once a character cannot be there
+ */
+static gint
+mask_core_checksum_step (MaskCoreChecksum checksum, gint n, gint state, gint i, gchar c)
+{
+	gint v, first, digits;
+
+	if (state < 0)
+		{
+			return state;
+		}
+
+	if (g_ascii_isdigit (c))
+		{
+			v = c - '0';
+		}
+	else if (g_ascii_isalpha (c))
+		{
+			v = g_ascii_toupper (c) - 'A' + 10;
+		}
+	else
+		{
+			return -1;
+		}
+
+	switch (checksum)
+		{
+			case MASK_CORE_CHECKSUM_LUHN:
+				if (v > 9)
+					{
+						return -1;
+					}
+				/* every second digit from the right one is doubled */
+				if ((n - 1 - i) % 2 == 1)
+					{
+						v = (v < 5 ? v * 2 : v * 2 - 9);
+					}
+				return (state + v) % 10;
+
+			case MASK_CORE_CHECKSUM_MOD_97_10:
+				return (state * (v > 9 ? 100 : 10) + v) % 97;
+
+			case MASK_CORE_CHECKSUM_IBAN:
+				/* the first four characters go at the end: their value, and
+				 * the number of its digits, are kept apart in the bits above
+				 * the first 8 */
+				if (i < 4)
+					{
+						first = ((state >> 8) & 0xff) * (v > 9 ? 100 : 10) + v;
+						digits = (state >> 16) + (v > 9 ? 2 : 1);
+						return (state & 0xff) | ((first % 97) << 8) | (digits << 16);
+					}
+				return (state & ~0xff) | (((state & 0xff) * (v > 9 ? 100 : 10) + v) % 97);
+
+			case MASK_CORE_CHECKSUM_MOD_11_2:
+				if (i < n - 1)
+					{
+						return (v > 9 ? -1 : (state + v) * 2 % 11);
+					}
+				/* the check character, 'X' for 10 */
+				if (v > 9)
+					{
+						if (g_ascii_toupper (c) != 'X')
+							{
+								return -1;
+							}
+						v = 10;
+					}
+				return (state + v) % 11;
+
+			default:
+				return state;
+		}
+}
+
+static gboolean
+mask_core_checksum_valid (MaskCoreChecksum checksum, gint state)
+{
+	gint rest, digits;
+
+	if (state < 0)
+		{
+			return FALSE;
+		}
+
+	switch (checksum)
+		{
+			case MASK_CORE_CHECKSUM_LUHN:
+				return state == 0;
+
+			case MASK_CORE_CHECKSUM_MOD_97_10:
+			case MASK_CORE_CHECKSUM_MOD_11_2:
+				return state == 1;
+
+			case MASK_CORE_CHECKSUM_IBAN:
+				rest = state & 0xff;
+				for (digits = state >> 16; digits > 0; digits--)
+					{
+						rest = rest * 10 % 97;
+					}
+				return (rest + ((state >> 8) & 0xff)) % 97 == 1;
+
+			default:
+				return TRUE;
+		}
+}
+
+/* the transitions of the trie, rebuilt from the prefixes at every change:
+ * nodes are numbered from the root, every one after its parent, and 0 is
+ * never the target of a transition */
+static void
+mask_core_set_build (MaskCoreSet *set)
+{
+	const gchar *prefix;
+	gint *parent;
+	gint i, l, node, max_nodes, *next;
+	guint e;
+
+	memset (set->columns, 0, sizeof (set->columns));
+	set->n_columns = 1;
+	max_nodes = 1;
+	for (e = 0; e < set->prefixes->len; e++)
+		{
+			for (prefix = g_ptr_array_index (set->prefixes, e); *prefix != '\0'; prefix++, max_nodes++)
+				{
+					if (set->columns[(guchar)*prefix] == 0)
+						{
+							set->columns[(guchar)*prefix] = set->n_columns++;
+						}
+				}
+		}
+
+	g_free (set->next);
+	g_free (set->node_mask);
+	set->next = g_new0 (gint, max_nodes * set->n_columns);
+	set->node_mask = g_new (gint, max_nodes);
+	parent = g_new (gint, max_nodes);
+
+	set->node_mask[0] = -1;
+	set->n_nodes = 1;
+	set->depth = 0;
+	for (e = 0; e < set->prefixes->len; e++)
+		{
+			prefix = g_ptr_array_index (set->prefixes, e);
+			l = strlen (prefix);
+			for (i = 0, node = 0; i < l; i++)
+				{
+					next = &set->next[node * set->n_columns + set->columns[(guchar)prefix[i]]];
+					if (*next == 0)
+						{
+							*next = set->n_nodes;
+							parent[set->n_nodes] = node;
+							set->node_mask[set->n_nodes] = -1;
+							set->n_nodes++;
+						}
+					node = *next;
+				}
+			set->node_mask[node] = e;
+			set->depth = MAX (set->depth, l);
+		}
+
+	/* every node takes the mask of its longest prefix */
+	if (set->node_mask[0] < 0)
+		{
+			set->node_mask[0] = 0;
+		}
+	for (node = 1; node < set->n_nodes; node++)
+		{
+			if (set->node_mask[node] < 0)
+				{
+					set->node_mask[node] = set->node_mask[parent[node]];
+				}
+		}
+
+	g_free (parent);
+}
+
+static void
+mask_core_free (MaskCore *mask)
+{
+	g_free (mask->text);
+	g_free (mask->literals);
+	g_free (mask->classes);
+	g_free (mask->writeable);
+	g_free (mask->slots);
+	g_free (mask->slot_classes);
+	g_free (mask->slot_at);
+	g_free (mask->blocks);
+	g_free (mask->block_at);
+	g_free (mask->next_block);
+	g_free (mask->prev_block);
+	g_free (mask);
+}
@@ -0,0 +1,251 @@
+/*
+ * MaskCore: the masks of GtkMaskedEntry without GTK+
+ * Copyright (C) 2005-2014 Andrea Zagli <azagli@libero.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __MASK_CORE_H__
+#define __MASK_CORE_H__
+
+#include <glib.h>
+
+
+G_BEGIN_DECLS
+
+
+/* the character shown on writeable positions not yet filled */
+#define MASK_CORE_PLACEHOLDER '_'
+
+typedef enum
+{
+	MASK_CORE_CLASS_LITERAL = 0,
+	MASK_CORE_CLASS_DIGIT,            /* '0' */
+	MASK_CORE_CLASS_DIGIT_NOT_ZERO,   /* '9' */
+	MASK_CORE_CLASS_ALPHA,            /* '@' */
+	MASK_CORE_CLASS_ALPHA_UPPER,      /* '^' */
+	MASK_CORE_CLASS_ALNUM,            /* '#' */
+	MASK_CORE_CLASS_CUSTOM            /* the first of mask_core_register_class() */
+} MaskCoreClass;
+
+/**
+ * MaskCoreChecksum:
+ * @MASK_CORE_CHECKSUM_NONE: no check digits.
+ * @MASK_CORE_CHECKSUM_LUHN: Luhn, as card numbers; "{luhn}" at the end of
+ * the mask.
+ * @MASK_CORE_CHECKSUM_MOD_97_10: ISO 7064 MOD 97-10 on digits and on
+ * letters as 10 to 35, as LEI codes; "{mod97}".
+ * @MASK_CORE_CHECKSUM_IBAN: MOD 97-10 with the first four characters moved
+ * to the end, as IBANs; "{iban}".
+ * @MASK_CORE_CHECKSUM_MOD_11_2: ISO 7064 MOD 11-2, the last character a
+ * digit or 'X', as ISNIs; "{mod11-2}".
+ *
+ * The check digits algorithms a mask can declare.
+ */
+typedef enum
+{
+	MASK_CORE_CHECKSUM_NONE = 0,
+	MASK_CORE_CHECKSUM_LUHN,
+	MASK_CORE_CHECKSUM_MOD_97_10,
+	MASK_CORE_CHECKSUM_IBAN,
+	MASK_CORE_CHECKSUM_MOD_11_2
+} MaskCoreChecksum;
+
+/**
+ * MaskCoreTransformFunc:
+ * @c: a character accepted by a class.
+ *
+ * Returns: the character written in place of @c, as g_ascii_toupper() does.
+ */
+typedef gchar (*MaskCoreTransformFunc) (gchar c);
+
+typedef struct _MaskCoreBlock MaskCoreBlock;
+typedef struct _MaskCore      MaskCore;
+typedef struct _MaskCoreSet   MaskCoreSet;
+
+/**
+ * MaskCoreBlock:
+ * @start: the first writeable position of the block.
+ * @end: the position following the last writeable one.
+ *
+ * A run of writeable positions.
+ */
+struct _MaskCoreBlock
+{
+	gint start;
+	gint end;
+};
+
+/**
+ * MaskCore:
+ * @text: the mask as given to mask_core_compile().
+ * @literals: the empty mask: literals, with #MASK_CORE_PLACEHOLDER on writeable
+ * positions.
+ * @classes: a #MaskCoreClass for every position.
+ * @writeable: one bit for every position, see MASK_CORE_IS_WRITEABLE().
+ * @length: the length of the mask.
+ * @n_writeable: the number of writeable positions.
+ * @slots: the writeable positions, in order.
+ * @slot_classes: the #MaskCoreClass of every writeable position, in order.
+ * @slot_at: for every position, from 0 to @length included, the index in
+ * @slots of the first writeable position at or after it.
+ * @blocks: the runs of writeable positions.
+ * @n_blocks: the number of @blocks.
+ * @block_at: for every cursor position, from 0 to @length included, the
+ * index of the block containing it, or -1.
+ * @next_block: for every cursor position, the start of the block to move to
+ * going right, or -1.
+ * @prev_block: for every cursor position, the start of the block to move to
+ * going left, or -1.
+ * @checksum: the check digits of the values, see mask_core_check_step().
+ *
+ * A compiled mask. It is immutable: all fields are read-only, and it can be
+ * shared, see mask_core_intern().
+ */
+struct _MaskCore
+{
+	gchar *text;
+	gchar *literals;
+	guint8 *classes;
+	guint32 *writeable;
+	gint length;
+	gint n_writeable;
+	gint *slots;
+	guint8 *slot_classes;
+	gint *slot_at;
+
+	MaskCoreBlock *blocks;
+	gint n_blocks;
+
+	gint *block_at;
+	gint *next_block;
+	gint *prev_block;
+
+	MaskCoreChecksum checksum;
+
+	/*< private >*/
+	gint ref_count;
+	gboolean interned;
+};
+
+#define MASK_CORE_IS_WRITEABLE(mask, pos) \
+	(((mask)->writeable[(pos) >> 5] & (1u << ((pos) & 31))) != 0)
+
+/* the bytes taken by a value with and without the mask, nul included */
+#define MASK_CORE_FORMATTED_SIZE(mask) ((gsize)(mask)->length + 1)
+#define MASK_CORE_UNFORMATTED_SIZE(mask) ((gsize)(mask)->n_writeable + 1)
+
+/* the state of the check digits before the first slot */
+#define MASK_CORE_CHECK_INIT 0
+
+
+gboolean mask_core_register_class (gchar mask_char,
+                                   const gchar *accepted,
+                                   MaskCoreTransformFunc transform);
+guint mask_core_get_n_classes (void);
+gchar mask_core_class_lookup (guint8 klass,
+                              gchar c);
+
+MaskCore *mask_core_compile (const gchar *mask);
+MaskCore *mask_core_intern (const gchar *mask);
+MaskCore *mask_core_ref (MaskCore *mask);
+void mask_core_unref (MaskCore *mask);
+
+gboolean mask_core_accept (const MaskCore *mask,
+                           gint position,
+                           gchar c,
+                           gchar *accepted);
+gint mask_core_get_first_writeable (const MaskCore *mask,
+                                    gint position);
+
+gint mask_core_validate (const MaskCore *mask,
+                         const gchar *raw,
+                         gssize length);
+gint mask_core_validate_formatted (const MaskCore *mask,
+                                   const gchar *text,
+                                   gssize length);
+gint mask_core_format (const MaskCore *mask,
+                       const gchar *raw,
+                       gssize length,
+                       gchar *buffer);
+gint mask_core_unformat (const MaskCore *mask,
+                         const gchar *text,
+                         gssize length,
+                         gchar *buffer);
+gint mask_core_format_slots (const MaskCore *mask,
+                             const gchar *slots,
+                             gssize length,
+                             gchar *buffer);
+
+guint mask_core_format_batch (const MaskCore *mask,
+                              const gchar * const *raws,
+                              guint n,
+                              gchar *arena);
+guint mask_core_format_packed (const MaskCore *mask,
+                               const gchar *packed,
+                               const gsize *offsets,
+                               guint n,
+                               gchar *arena);
+void mask_core_unformat_batch (const MaskCore *mask,
+                               const gchar * const *texts,
+                               guint n,
+                               gchar *arena);
+
+gint mask_core_insert (const MaskCore *mask,
+                       const gchar *text,
+                       gssize length,
+                       gint *position,
+                       gchar *buffer);
+const gchar *mask_core_erase (const MaskCore *mask,
+                              gint *start_pos,
+                              gint *end_pos);
+gint mask_core_apply_keystroke (const MaskCore *mask,
+                                gchar *text,
+                                gint position,
+                                gchar c);
+
+gint mask_core_check_step (const MaskCore *mask,
+                           gint state,
+                           gint slot,
+                           gchar c);
+gboolean mask_core_check_finish (const MaskCore *mask,
+                                 gint state);
+gboolean mask_core_check (const MaskCore *mask,
+                          const gchar *raw,
+                          gssize length);
+guint mask_core_check_batch (const MaskCore *mask,
+                             const gchar * const *raws,
+                             guint n,
+                             gboolean *valid);
+gboolean mask_core_checksum_verify (MaskCoreChecksum checksum,
+                                    const gchar *value,
+                                    gssize length);
+
+MaskCoreSet *mask_core_set_new (void);
+MaskCoreSet *mask_core_set_ref (MaskCoreSet *set);
+void mask_core_set_unref (MaskCoreSet *set);
+void mask_core_set_add (MaskCoreSet *set,
+                        const gchar *prefix,
+                        const gchar *mask);
+MaskCore *mask_core_set_lookup (const MaskCoreSet *set,
+                                const gchar *raw,
+                                gssize length);
+
+
+G_END_DECLS
+
+
+#endif /* __MASK_CORE_H__ */
@@ -0,0 +1,386 @@
+/*
+ * GtkCellRendererMasked test
+ * Copyright (C) 2005-2014 Andrea Zagli <azagli@libero.it>
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this software; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+
+#include <gtk/gtk.h>
+
+#include <gtkmaskedentry.h>
+#include <gtkcellrenderermasked.h>
+
+/* exit status that automake's test driver reports as skipped */
+#define EXIT_SKIP 77
+
+/* the text the renderer shows for a row */
+static gchar *
+render (GtkTreeViewColumn *column, GtkCellRenderer *renderer, GtkTreeModel *model, GtkTreeIter *iter)
+{
+	gchar *text;
+
+	gtk_tree_view_column_cell_set_cell_data (column, model, iter, FALSE, FALSE);
+	g_object_get (G_OBJECT (renderer), "text", &text, NULL);
+
+	return text;
+}
+
+static void
+test_raw_column (void)
+{
+	GtkListStore *store;
+	GtkTreeModel *model;
+	GtkTreeViewColumn *column;
+	GtkCellRenderer *renderer;
+	GtkTreeIter iters[3];
+	gchar *text;
+
+	store = gtk_list_store_new (1, G_TYPE_STRING);
+	model = GTK_TREE_MODEL (store);
+	gtk_list_store_append (store, &iters[0]);
+	gtk_list_store_set (store, &iters[0], 0, "12052020", -1);
+	gtk_list_store_append (store, &iters[1]);
+	gtk_list_store_set (store, &iters[1], 0, "", -1);
+	gtk_list_store_append (store, &iters[2]);
+	gtk_list_store_set (store, &iters[2], 0, "0101", -1);
+
+	renderer = gtk_cell_renderer_masked_new_with_mask ("00/00/0000");
+	column = gtk_tree_view_column_new ();
+	g_object_ref_sink (column);
+	gtk_tree_view_column_pack_start (column, renderer, TRUE);
+	gtk_cell_renderer_masked_set_raw_column (GTK_CELL_RENDERER_MASKED (renderer), column, 0);
+
+	text = render (column, renderer, model, &iters[0]);
+	g_assert (strcmp (text, "12/05/2020") == 0);
+	g_free (text);
+
+	text = render (column, renderer, model, &iters[1]);
+	g_assert (strcmp (text, "") == 0);
+	g_free (text);
+
+	text = render (column, renderer, model, &iters[2]);
+	g_assert (strcmp (text, "01/01/____") == 0);
+	g_free (text);
+
+	/* from the cache */
+	text = render (column, renderer, model, &iters[0]);
+	g_assert (strcmp (text, "12/05/2020") == 0);
+	g_free (text);
+
+	/* a changed row is formatted again */
+	gtk_list_store_set (store, &iters[0], 0, "31121999", -1);
+	text = render (column, renderer, model, &iters[0]);
+	g_assert (strcmp (text, "31/12/1999") == 0);
+	g_free (text);
+
+	/* as with a new mask */
+	gtk_cell_renderer_masked_set_mask (GTK_CELL_RENDERER_MASKED (renderer), "00-00-0000");
+	text = render (column, renderer, model, &iters[0]);
+	g_assert (strcmp (text, "31-12-1999") == 0);
+	g_free (text);
+
+	/* and with a cache of one row */
+	g_object_set (G_OBJECT (renderer), "cache-size", 1, NULL);
+	text = render (column, renderer, model, &iters[2]);
+	g_free (text);
+	text = render (column, renderer, model, &iters[0]);
+	g_assert (strcmp (text, "31-12-1999") == 0);
+	g_free (text);
+
+	g_object_unref (column);
+	g_object_unref (store);
+}
+
+static void
+test_row_mask (void)
+{
+	GtkListStore *store;
+	GtkTreeModel *model;
+	GtkTreeViewColumn *column;
+	GtkCellRenderer *renderer;
+	GtkTreeIter iters[3];
+	gchar *text;
+
+	store = gtk_list_store_new (2, G_TYPE_STRING, G_TYPE_STRING);
+	model = GTK_TREE_MODEL (store);
+	gtk_list_store_insert_with_values (store, &iters[0], 0, 0, "0612345678", 1, "+00 0 00 00 00 00", -1);
+	gtk_list_store_insert_with_values (store, &iters[1], 1, 0, "2025550123", 1, "(000) 000-0000", -1);
+	gtk_list_store_insert_with_values (store, &iters[2], 2, 0, "12052020", 1, NULL, -1);
+
+	renderer = gtk_cell_renderer_masked_new_with_mask ("00/00/0000");
+	column = gtk_tree_view_column_new ();
+	g_object_ref_sink (column);
+	gtk_tree_view_column_pack_start (column, renderer, TRUE);
+	gtk_tree_view_column_add_attribute (column, renderer, "row-mask", 1);
+	gtk_cell_renderer_masked_set_raw_column (GTK_CELL_RENDERER_MASKED (renderer), column, 0);
+
+	text = render (column, renderer, model, &iters[0]);
+	g_assert (strcmp (text, "+06 1 23 45 67 8_") == 0);
+	g_free (text);
+	text = render (column, renderer, model, &iters[1]);
+	g_assert (strcmp (text, "(202) 555-0123") == 0);
+	g_free (text);
+
+	/* without a mask of its own, the row has the mask of the column */
+	text = render (column, renderer, model, &iters[2]);
+	g_assert (strcmp (text, "12/05/2020") == 0);
+	g_free (text);
+
+	/* the row gets another mask */
+	gtk_list_store_set (store, &iters[0], 1, "00 00 00 00 00", -1);
+	text = render (column, renderer, model, &iters[0]);
+	g_assert (strcmp (text, "06 12 34 56 78") == 0);
+	g_free (text);
+
+	g_object_unref (column);
+	g_object_unref (store);
+}
+
+static void
+test_size_from_mask (void)
+{
+	GtkCellRenderer *renderer;
+	GtkWidget *view;
+	gint measured, from_mask, natural;
+
+	view = gtk_tree_view_new ();
+	g_object_ref_sink (view);
+
+	renderer = gtk_cell_renderer_masked_new_with_mask ("00/00/0000");
+	g_object_ref_sink (renderer);
+	g_object_set (G_OBJECT (renderer), "text", "11/11/1111", NULL);
+	gtk_cell_renderer_get_preferred_width (renderer, view, &measured, NULL);
+
+	/* as wide as the widest value, whatever the text of the row */
+	g_object_set (G_OBJECT (renderer), "size-from-mask", TRUE, "text", "", NULL);
+	gtk_cell_renderer_get_preferred_width (renderer, view, &from_mask, &natural);
+	g_assert (from_mask >= measured);
+	g_assert (natural == from_mask);
+
+	g_object_set (G_OBJECT (renderer), "text", "12/05/2020", NULL);
+	gtk_cell_renderer_get_preferred_width (renderer, view, &natural, NULL);
+	g_assert (natural == from_mask);
+
+	/* measured again for another mask */
+	g_object_set (G_OBJECT (renderer), "mask", "00/00/0000 00:00", NULL);
+	gtk_cell_renderer_get_preferred_width (renderer, view, &natural, NULL);
+	g_assert (natural > from_mask);
+
+	g_object_unref (renderer);
+	g_object_unref (view);
+}
+
+static void
+edited_cb (GtkCellRendererText *renderer, gchar *path, gchar *new_text, gpointer data)
+{
+	(*(gint *)data)++;
+}
+
+static gint activated = 0;
+
+static void
+activated_cb (GtkEntry *entry, gpointer data)
+{
+	activated++;
+}
+
+/* what a tree view does with an editor: in, edited, out */
+static GtkCellEditable *
+edit (GtkCellRenderer *renderer, GtkWidget *view, const gchar *text)
+{
+	GdkRectangle area = { 0, 0, 100, 20 };
+	GtkCellEditable *editable;
+
+	editable = gtk_cell_renderer_start_editing (renderer, NULL, view, "0",
+	                                            &area, &area, 0);
+	g_assert (strcmp (gtk_entry_get_text (GTK_ENTRY (editable)), text) == 0);
+
+	gtk_container_add (GTK_CONTAINER (view), GTK_WIDGET (editable));
+	gtk_cell_editable_start_editing (editable, NULL);
+	g_signal_emit_by_name (editable, "activate");
+	gtk_container_remove (GTK_CONTAINER (view), GTK_WIDGET (editable));
+
+	return editable;
+}
+
+static void
+test_editor_pool (void)
+{
+	GtkCellRenderer *renderer;
+	GtkWidget *view;
+	GtkCellEditable *first, *second;
+	gint edited = 0;
+	gchar *row_mask;
+	gint i;
+
+	view = gtk_fixed_new ();
+	g_object_ref_sink (view);
+
+	renderer = gtk_cell_renderer_masked_new ();
+	g_object_ref_sink (renderer);
+	g_object_set (G_OBJECT (renderer), "mask", "00/00", "editable", TRUE,
+	              "text", "12/05", NULL);
+	g_signal_connect (renderer, "edited", G_CALLBACK (edited_cb), &edited);
+
+	first = edit (renderer, view, "12/05");
+	g_assert (edited == 1);
+
+	/* the same editor, with the new text and edited only once; the
+	 * handlers of the application stay */
+	g_signal_connect (first, "activate", G_CALLBACK (activated_cb), NULL);
+	g_object_set (G_OBJECT (renderer), "text", "01/01", NULL);
+	second = edit (renderer, view, "01/01");
+	g_assert (second == first);
+	g_assert (edited == 2);
+	g_assert (activated == 1);
+
+	/* another mask, another editor; the idle ones of the old mask go */
+	g_object_add_weak_pointer (G_OBJECT (first), (gpointer *)&first);
+	g_object_set (G_OBJECT (renderer), "mask", "00:00", "text", "", NULL);
+	g_assert (first == NULL);
+	second = edit (renderer, view, "__:__");
+	g_assert (edited == 3);
+
+	/* the masks of the rows are kept for the last rows only, and their idle
+	 * editors with them */
+	g_object_set (G_OBJECT (renderer), "row-mask", "AA-00", "text", "", NULL);
+	first = edit (renderer, view, "__-__");
+	g_object_add_weak_pointer (G_OBJECT (first), (gpointer *)&first);
+	for (i = 1; i <= 64; i++)
+		{
+			row_mask = g_strnfill (i, '0');
+			g_object_set (G_OBJECT (renderer), "row-mask", row_mask, NULL);
+			g_free (row_mask);
+		}
+	g_assert (first == NULL);
+
+	g_object_unref (renderer);
+	g_object_unref (view);
+}
+
+static void
+edited_raw_cb (GtkCellRendererMasked *renderer, gchar *path, gchar *raw_text, gpointer data)
+{
+	g_free (*(gchar **)data);
+	*(gchar **)data = g_strdup (raw_text);
+}
+
+/* an edit of the row of tree, typing raw in the editor */
+static void
+edit_raw (GtkCellRenderer *renderer, GtkWidget *tree, GtkWidget *view, const gchar *raw)
+{
+	GdkRectangle area = { 0, 0, 100, 20 };
+	GtkCellEditable *editable;
+
+	editable = gtk_cell_renderer_start_editing (renderer, NULL, tree, "0",
+	                                            &area, &area, 0);
+	gtk_container_add (GTK_CONTAINER (view), GTK_WIDGET (editable));
+	gtk_cell_editable_start_editing (editable, NULL);
+	gtk_masked_entry_set_text (GTK_MASKED_ENTRY (editable), raw);
+	g_signal_emit_by_name (editable, "activate");
+	gtk_container_remove (GTK_CONTAINER (view), GTK_WIDGET (editable));
+}
+
+static void
+test_edited_raw (void)
+{
+	GtkListStore *store, *other;
+	GtkTreeViewColumn *column;
+	GtkCellRenderer *renderer;
+	GtkWidget *view, *tree, *other_tree;
+	GtkTreeIter iter, other_iter;
+	gchar *raw = NULL, *text;
+	gint edited = 0;
+
+	view = gtk_fixed_new ();
+	g_object_ref_sink (view);
+
+	store = gtk_list_store_new (1, G_TYPE_STRING);
+	gtk_list_store_insert_with_values (store, &iter, 0, 0, "12052020", -1);
+	tree = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+	g_object_ref_sink (tree);
+	other = gtk_list_store_new (1, G_TYPE_STRING);
+	gtk_list_store_insert_with_values (other, &other_iter, 0, 0, "01012000", -1);
+	other_tree = gtk_tree_view_new_with_model (GTK_TREE_MODEL (other));
+	g_object_ref_sink (other_tree);
+
+	renderer = gtk_cell_renderer_masked_new_with_mask ("00/00/0000");
+	g_object_set (G_OBJECT (renderer), "editable", TRUE, NULL);
+	column = gtk_tree_view_column_new ();
+	g_object_ref_sink (column);
+	gtk_tree_view_column_pack_start (column, renderer, TRUE);
+	gtk_cell_renderer_masked_set_raw_column (GTK_CELL_RENDERER_MASKED (renderer), column, 0);
+	g_signal_connect (renderer, "edited", G_CALLBACK (edited_cb), &edited);
+	g_signal_connect (renderer, "edited-raw", G_CALLBACK (edited_raw_cb), &raw);
+
+	text = render (column, renderer, GTK_TREE_MODEL (store), &iter);
+	g_free (text);
+
+	edit_raw (renderer, tree, view, "0101");
+	g_assert (edited == 1);
+	g_assert (strcmp (raw, "0101") == 0);
+
+	/* straight into the model, without the handlers */
+	g_object_set (G_OBJECT (renderer), "write-raw", TRUE, NULL);
+	edit_raw (renderer, tree, view, "31121999");
+	g_assert (edited == 1);
+	g_assert (strcmp (raw, "0101") == 0);
+	gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &text, -1);
+	g_assert (strcmp (text, "31121999") == 0);
+	g_free (text);
+
+	text = render (column, renderer, GTK_TREE_MODEL (store), &iter);
+	g_assert (strcmp (text, "31/12/1999") == 0);
+	g_free (text);
+
+	/* into the model of the view edited, not of the one rendered last */
+	edit_raw (renderer, other_tree, view, "02022002");
+	gtk_tree_model_get (GTK_TREE_MODEL (other), &other_iter, 0, &text, -1);
+	g_assert (strcmp (text, "02022002") == 0);
+	g_free (text);
+	gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &text, -1);
+	g_assert (strcmp (text, "31121999") == 0);
+	g_free (text);
+
+	g_free (raw);
+	g_object_unref (column);
+	g_object_unref (other_tree);
+	g_object_unref (other);
+	g_object_unref (tree);
+	g_object_unref (store);
+	g_object_unref (view);
+}
+
+int
+main (int argc, char **argv)
+{
+	g_setenv ("NO_AT_BRIDGE", "1", TRUE);
+	if (!gtk_init_check (&argc, &argv))
+		{
+			g_printerr ("Unable to initialize GTK+.\n");
+			return EXIT_SKIP;
+		}
+
+	test_raw_column ();
+	test_row_mask ();
+	test_size_from_mask ();
+	test_editor_pool ();
+	test_edited_raw ();
+
+	return 0;
+}
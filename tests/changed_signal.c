@@ -0,0 +1,324 @@
+/*
+ * GtkMaskedEntry "changed" signal test
+ * Copyright (C) 2005-2014 Andrea Zagli <azagli@libero.it>
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this software; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+
+#include <gtk/gtk.h>
+
+#include <gtkmaskedentry.h>
+#include <gtkmaskedentrybuffer.h>
+
+/* exit status that automake's test driver reports as skipped */
+#define EXIT_SKIP 77
+
+static guint changed = 0;
+static guint raw_text_notified = 0;
+
+static void
+on_changed (GtkEditable *editable, gpointer user_data)
+{
+	changed++;
+}
+
+static void
+on_scan_complete (GtkMaskedEntry *masked_entry, gpointer user_data)
+{
+	(*(guint *)user_data)++;
+}
+
+static void
+on_mask_notify (GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	(*(guint *)user_data)++;
+}
+
+static void
+on_raw_text_notify (GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	raw_text_notified++;
+}
+
+/* Backspace, as GtkEntry does it, across a literal and an empty slot: the
+ * text does not change there, the cursor must still move back */
+static void
+check_backspace (GtkWidget *masked_entry)
+{
+	GtkEditable *editable = GTK_EDITABLE (masked_entry);
+	gint pos;
+
+	gtk_masked_entry_set_text (GTK_MASKED_ENTRY (masked_entry), "");
+	pos = 0;
+	gtk_editable_insert_text (editable, "12", 2, &pos);
+	gtk_editable_set_position (editable, 3);
+
+	gtk_editable_delete_text (editable, 2, 3);
+	g_assert (gtk_editable_get_position (editable) == 2);
+	gtk_editable_delete_text (editable, 1, 2);
+	g_assert (gtk_editable_get_position (editable) == 1);
+	g_assert (strcmp (gtk_entry_get_text (GTK_ENTRY (masked_entry)), "1_/__/____") == 0);
+
+	gtk_editable_set_position (editable, 5);
+	gtk_editable_delete_text (editable, 4, 5);
+	g_assert (gtk_editable_get_position (editable) == 4);
+	gtk_editable_delete_text (editable, 3, 4);
+	g_assert (gtk_editable_get_position (editable) == 3);
+	gtk_editable_delete_text (editable, 2, 3);
+	g_assert (gtk_editable_get_position (editable) == 2);
+}
+
+int
+main (int argc, char **argv)
+{
+	GtkWidget *masked_entry;
+	GtkEditable *editable;
+	GtkMaskedEntryBuffer *buffer;
+	GtkEntryBuffer *plain;
+	GdkEventKey key = { GDK_KEY_PRESS };
+	const gchar *raw;
+	const gchar *scanned = "24121999";
+	guint scans = 0;
+	guint masks = 0;
+	guint valid_notified = 0;
+	guint complete_notified = 0;
+	guint filled_notified = 0;
+	gint pos;
+
+	g_setenv ("NO_AT_BRIDGE", "1", TRUE);
+	if (!gtk_init_check (&argc, &argv))
+		{
+			g_printerr ("Unable to initialize GTK+.\n");
+			return EXIT_SKIP;
+		}
+
+	masked_entry = gtk_masked_entry_new_with_mask ("00/00/0000");
+	g_object_ref_sink (masked_entry);
+	editable = GTK_EDITABLE (masked_entry);
+	buffer = GTK_MASKED_ENTRY_BUFFER (gtk_entry_get_buffer (GTK_ENTRY (masked_entry)));
+
+	g_signal_connect (G_OBJECT (masked_entry), "changed",
+	                  G_CALLBACK (on_changed), NULL);
+	g_signal_connect (G_OBJECT (masked_entry), "notify::raw-text",
+	                  G_CALLBACK (on_raw_text_notify), NULL);
+
+	/* one keystroke */
+	pos = 0;
+	gtk_editable_insert_text (editable, "1", 1, &pos);
+	g_assert (changed == 1);
+	g_assert (pos == 1);
+
+	/* a paste over the literals */
+	changed = 0;
+	pos = 0;
+	gtk_editable_insert_text (editable, "12/05/2020", -1, &pos);
+	g_assert (changed == 1);
+	g_assert (strcmp (gtk_entry_get_text (GTK_ENTRY (masked_entry)), "12/05/2020") == 0);
+
+	/* typing over a selection, as GtkEntry does it */
+	changed = 0;
+	gtk_editable_select_region (editable, 3, 5);
+	gtk_editable_delete_selection (editable);
+	pos = 3;
+	gtk_editable_insert_text (editable, "0", 1, &pos);
+	g_assert (changed == 2);
+	g_assert (strcmp (gtk_entry_get_text (GTK_ENTRY (masked_entry)), "12/0_/2020") == 0);
+
+	/* a range, and then again the same range: nothing left to change */
+	changed = 0;
+	gtk_editable_delete_text (editable, 0, -1);
+	g_assert (changed == 1);
+	gtk_editable_delete_text (editable, 0, -1);
+	g_assert (changed == 1);
+	g_assert (strcmp (gtk_entry_get_text (GTK_ENTRY (masked_entry)), "__/__/____") == 0);
+	g_assert (gtk_masked_entry_buffer_get_raw_length (buffer) == 0);
+
+	/* the value without the mask, straight into the buffer */
+	changed = 0;
+	g_assert (gtk_masked_entry_buffer_set_raw_text (buffer, "3112x", -1) == 4);
+	g_assert (changed == 1);
+	g_assert (strcmp (gtk_entry_get_text (GTK_ENTRY (masked_entry)), "31/12/____") == 0);
+	g_assert (strcmp (gtk_masked_entry_buffer_get_slots (buffer), "3112____") == 0);
+	g_assert (gtk_masked_entry_buffer_get_raw_length (buffer) == 4);
+	raw = gtk_masked_entry_get_text (GTK_MASKED_ENTRY (masked_entry));
+	g_assert (strcmp (raw, "3112") == 0);
+
+	/* the value without the mask is borrowed and notified once a change */
+	changed = 0;
+	raw_text_notified = 0;
+	pos = 6;
+	gtk_editable_insert_text (editable, "19", 2, &pos);
+	g_assert (changed == 1);
+	g_assert (raw_text_notified == 1);
+	g_assert (gtk_masked_entry_get_text (GTK_MASKED_ENTRY (masked_entry)) == raw);
+	g_assert (strcmp (raw, "311219") == 0);
+
+	/* a hole in the middle */
+	gtk_editable_delete_text (editable, 1, 2);
+	g_assert (strcmp (gtk_masked_entry_get_text (GTK_MASKED_ENTRY (masked_entry)), "31219") == 0);
+	gtk_masked_entry_set_text (GTK_MASKED_ENTRY (masked_entry), "01022003");
+	g_assert (strcmp (gtk_entry_get_text (GTK_ENTRY (masked_entry)), "01/02/2003") == 0);
+	g_assert (strcmp (gtk_masked_entry_get_text (GTK_MASKED_ENTRY (masked_entry)), "01022003") == 0);
+
+	/* a new mask keeps the value, in one change */
+	g_signal_connect (G_OBJECT (masked_entry), "notify::mask",
+	                  G_CALLBACK (on_mask_notify), &masks);
+	changed = 0;
+	gtk_masked_entry_set_mask (GTK_MASKED_ENTRY (masked_entry), "0000-00-00");
+	g_assert (changed == 1);
+	g_assert (masks == 1);
+	g_assert (strcmp (gtk_entry_get_text (GTK_ENTRY (masked_entry)), "0102-20-03") == 0);
+	gtk_masked_entry_set_mask (GTK_MASKED_ENTRY (masked_entry), "00.00");
+	g_assert (strcmp (gtk_masked_entry_get_text (GTK_MASKED_ENTRY (masked_entry)), "0102") == 0);
+	gtk_masked_entry_set_mask (GTK_MASKED_ENTRY (masked_entry), "00/00/0000");
+	g_assert (changed == 3);
+	g_assert (masks == 3);
+	g_assert (strcmp (gtk_entry_get_text (GTK_ENTRY (masked_entry)), "01/02/____") == 0);
+
+	/* a barcode: the keys held and inserted at once, when the terminator of
+	 * the scanner comes; the main loop is not run, so the timeout does not
+	 * flush them first */
+	gtk_masked_entry_set_text (GTK_MASKED_ENTRY (masked_entry), "");
+	gtk_editable_set_position (editable, 0);
+	g_object_set (G_OBJECT (masked_entry), "burst-interval", 50, NULL);
+	g_signal_connect (G_OBJECT (masked_entry), "scan-complete",
+	                  G_CALLBACK (on_scan_complete), &scans);
+	changed = 0;
+	for (; *scanned != '\0'; scanned++)
+		{
+			key.keyval = gdk_unicode_to_keyval (*scanned);
+			GTK_WIDGET_GET_CLASS (masked_entry)->key_press_event (masked_entry, &key);
+		}
+	g_assert (changed == 0);
+	g_assert (scans == 0);
+	key.keyval = GDK_KEY_Return;
+	GTK_WIDGET_GET_CLASS (masked_entry)->key_press_event (masked_entry, &key);
+	g_assert (scans == 1);
+	g_assert (changed == 1);
+	g_assert (strcmp (gtk_entry_get_text (GTK_ENTRY (masked_entry)), "24/12/1999") == 0);
+
+	/* a key alone is no scan, and nothing is typed when not editable */
+	gtk_masked_entry_set_text (GTK_MASKED_ENTRY (masked_entry), "");
+	gtk_editable_set_position (editable, 0);
+	key.keyval = gdk_unicode_to_keyval ('3');
+	GTK_WIDGET_GET_CLASS (masked_entry)->key_press_event (masked_entry, &key);
+	key.keyval = GDK_KEY_Return;
+	GTK_WIDGET_GET_CLASS (masked_entry)->key_press_event (masked_entry, &key);
+	g_assert (strcmp (gtk_entry_get_text (GTK_ENTRY (masked_entry)), "3_/__/____") == 0);
+	g_assert (scans == 1);
+	gtk_editable_set_editable (editable, FALSE);
+	key.keyval = gdk_unicode_to_keyval ('1');
+	GTK_WIDGET_GET_CLASS (masked_entry)->key_press_event (masked_entry, &key);
+	key.keyval = gdk_unicode_to_keyval ('2');
+	GTK_WIDGET_GET_CLASS (masked_entry)->key_press_event (masked_entry, &key);
+	key.keyval = GDK_KEY_Return;
+	GTK_WIDGET_GET_CLASS (masked_entry)->key_press_event (masked_entry, &key);
+	g_assert (strcmp (gtk_entry_get_text (GTK_ENTRY (masked_entry)), "3_/__/____") == 0);
+	g_assert (scans == 1);
+
+	g_object_unref (masked_entry);
+
+	/* Backspace on GtkMaskedEntryBuffer, and on another buffer */
+	masked_entry = gtk_masked_entry_new_with_mask ("00/00/0000");
+	g_object_ref_sink (masked_entry);
+	check_backspace (masked_entry);
+	g_object_unref (masked_entry);
+
+	masked_entry = gtk_masked_entry_new ();
+	g_object_ref_sink (masked_entry);
+	plain = gtk_entry_buffer_new (NULL, -1);
+	gtk_entry_set_buffer (GTK_ENTRY (masked_entry), plain);
+	g_object_unref (plain);
+	gtk_masked_entry_set_mask (GTK_MASKED_ENTRY (masked_entry), "00/00/0000");
+	g_assert (!GTK_IS_MASKED_ENTRY_BUFFER (gtk_entry_get_buffer (GTK_ENTRY (masked_entry))));
+	check_backspace (masked_entry);
+	g_object_unref (masked_entry);
+
+	/* alternative masks, chosen as the value is typed */
+	masked_entry = gtk_masked_entry_new_with_mask ("0000 0000 0000 0000");
+	g_object_ref_sink (masked_entry);
+	editable = GTK_EDITABLE (masked_entry);
+	gtk_masked_entry_add_mask (GTK_MASKED_ENTRY (masked_entry), "34", "0000 000000 00000");
+	gtk_masked_entry_add_mask (GTK_MASKED_ENTRY (masked_entry), "37", "0000 000000 00000");
+	pos = 0;
+	gtk_editable_insert_text (editable, "3", 1, &pos);
+	g_assert (strcmp (gtk_masked_entry_get_mask (GTK_MASKED_ENTRY (masked_entry)), "0000 0000 0000 0000") == 0);
+	gtk_editable_insert_text (editable, "7", 1, &pos);
+	g_assert (strcmp (gtk_masked_entry_get_mask (GTK_MASKED_ENTRY (masked_entry)), "0000 000000 00000") == 0);
+	g_assert (pos == 2);
+	gtk_editable_insert_text (editable, "1449", 4, &pos);
+	g_assert (pos == 7);
+	g_assert (strcmp (gtk_entry_get_text (GTK_ENTRY (masked_entry)), "3714 49____ _____") == 0);
+	/* the slots keep their place, the empty one too, and so does the cursor */
+	gtk_editable_set_position (editable, 10);
+	gtk_editable_delete_text (editable, 0, 1);
+	g_assert (strcmp (gtk_masked_entry_get_mask (GTK_MASKED_ENTRY (masked_entry)), "0000 0000 0000 0000") == 0);
+	g_assert (strcmp (gtk_masked_entry_get_text (GTK_MASKED_ENTRY (masked_entry)), "71449") == 0);
+	g_assert (strcmp (gtk_entry_get_text (GTK_ENTRY (masked_entry)), "_714 49__ ____ ____") == 0);
+	g_assert (gtk_editable_get_position (editable) == 11);
+	g_signal_connect (G_OBJECT (masked_entry), "changed",
+	                  G_CALLBACK (on_changed), NULL);
+	changed = 0;
+	gtk_masked_entry_set_text (GTK_MASKED_ENTRY (masked_entry), "341234567890123");
+	g_assert (strcmp (gtk_entry_get_text (GTK_ENTRY (masked_entry)), "3412 345678 90123") == 0);
+	g_assert (changed == 1);
+	g_object_unref (masked_entry);
+
+	/* check digits, kept as the value is typed */
+	masked_entry = gtk_masked_entry_new_with_mask ("0000 0000 0000 0000{luhn}");
+	g_object_ref_sink (masked_entry);
+	editable = GTK_EDITABLE (masked_entry);
+	g_signal_connect (G_OBJECT (masked_entry), "notify::valid",
+	                  G_CALLBACK (on_mask_notify), &valid_notified);
+	g_signal_connect (G_OBJECT (masked_entry), "notify::is-complete",
+	                  G_CALLBACK (on_mask_notify), &complete_notified);
+	g_signal_connect (G_OBJECT (masked_entry), "notify::filled-count",
+	                  G_CALLBACK (on_mask_notify), &filled_notified);
+	g_assert (!gtk_masked_entry_get_valid (GTK_MASKED_ENTRY (masked_entry)));
+	g_assert (!gtk_masked_entry_is_complete (GTK_MASKED_ENTRY (masked_entry)));
+	pos = 0;
+	for (scanned = "4111111111111111"; *scanned != '\0'; scanned++)
+		{
+			gtk_editable_insert_text (editable, scanned, 1, &pos);
+			g_assert (gtk_masked_entry_get_filled_count (GTK_MASKED_ENTRY (masked_entry)) == (gint)filled_notified);
+		}
+	g_assert (gtk_masked_entry_get_valid (GTK_MASKED_ENTRY (masked_entry)));
+	g_assert (gtk_masked_entry_is_complete (GTK_MASKED_ENTRY (masked_entry)));
+	g_assert (valid_notified == 1);
+	g_assert (complete_notified == 1);
+	g_assert (filled_notified == 16);
+
+	/* a digit replaced: still complete, no longer valid */
+	pos = 5;
+	gtk_editable_insert_text (editable, "2", 1, &pos);
+	g_assert (!gtk_masked_entry_get_valid (GTK_MASKED_ENTRY (masked_entry)));
+	g_assert (gtk_masked_entry_is_complete (GTK_MASKED_ENTRY (masked_entry)));
+	g_assert (valid_notified == 2);
+	g_assert (complete_notified == 1);
+	g_assert (filled_notified == 16);
+
+	gtk_editable_delete_text (editable, 10, 12);
+	g_assert (gtk_masked_entry_get_filled_count (GTK_MASKED_ENTRY (masked_entry)) == 14);
+	g_assert (complete_notified == 2);
+	g_assert (filled_notified == 17);
+	gtk_masked_entry_set_text (GTK_MASKED_ENTRY (masked_entry), "4012888888881881");
+	g_assert (gtk_masked_entry_get_valid (GTK_MASKED_ENTRY (masked_entry)));
+	g_object_unref (masked_entry);
+
+	return 0;
+}
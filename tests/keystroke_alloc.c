@@ -0,0 +1,156 @@
+/*
+ * GtkMaskedEntry keystroke allocations test
+ * Copyright (C) 2005-2014 Andrea Zagli <azagli@libero.it>
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this software; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <gtk/gtk.h>
+
+#include <gtkmaskedentry.h>
+
+#define KEYSTROKES 1000
+
+/* exit status that automake's test driver reports as skipped */
+#define EXIT_SKIP 77
+
+/* g_mem_set_vtable() is a no-op since GLib 2.46, so allocations are counted
+ * by interposing the allocator of the C library: g_malloc() and friends
+ * end up here */
+#ifdef __GLIBC__
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+
+static gboolean counting = FALSE;
+static guint allocations = 0;
+
+void
+*malloc (size_t size)
+{
+	if (counting)
+		{
+			allocations++;
+		}
+	return __libc_malloc (size);
+}
+
+void
+*calloc (size_t nmemb, size_t size)
+{
+	if (counting)
+		{
+			allocations++;
+		}
+	return __libc_calloc (nmemb, size);
+}
+
+void
+*realloc (void *ptr, size_t size)
+{
+	if (counting)
+		{
+			allocations++;
+		}
+	return __libc_realloc (ptr, size);
+}
+#endif
+
+/* one keystroke as GtkEntry does it: insert at the cursor and move it */
+static gint
+type_char (GtkEditable *editable, const gchar *c)
+{
+	gint pos = gtk_editable_get_position (editable);
+
+	gtk_editable_insert_text (editable, c, 1, &pos);
+	gtk_editable_set_position (editable, pos);
+
+	return pos;
+}
+
+/* one backspace as GtkEntry does it */
+static void
+backspace (GtkEditable *editable)
+{
+	gint pos = gtk_editable_get_position (editable);
+
+	if (pos > 0)
+		{
+			gtk_editable_delete_text (editable, pos - 1, pos);
+		}
+}
+
+static guint
+keystrokes (GtkEditable *editable, guint n)
+{
+	guint i;
+	guint ret = 0;
+
+	for (i = 0; i < n; i++)
+		{
+#ifdef __GLIBC__
+			allocations = 0;
+			counting = TRUE;
+#endif
+			if (type_char (editable, i % 3 == 0 ? "a" : "1") >= 10)
+				{
+					backspace (editable);
+					backspace (editable);
+				}
+#ifdef __GLIBC__
+			counting = FALSE;
+			ret += allocations;
+#endif
+		}
+
+	return ret;
+}
+
+int
+main (int argc, char **argv)
+{
+	GtkWidget *masked_entry;
+	guint allocated;
+
+#ifndef __GLIBC__
+	g_printerr ("Counting allocations needs the GNU C library.\n");
+	return EXIT_SKIP;
+#endif
+
+	g_setenv ("NO_AT_BRIDGE", "1", TRUE);
+	if (!gtk_init_check (&argc, &argv))
+		{
+			g_printerr ("Unable to initialize GTK+.\n");
+			return EXIT_SKIP;
+		}
+
+	masked_entry = gtk_masked_entry_new_with_mask ("##/##/####");
+	g_object_ref_sink (masked_entry);
+
+	/* reach the steady state of the buffer and of the signal machinery */
+	keystrokes (GTK_EDITABLE (masked_entry), 20);
+
+	allocated = keystrokes (GTK_EDITABLE (masked_entry), KEYSTROKES);
+
+	g_print ("%u keystrokes: %u allocations\n", KEYSTROKES, allocated);
+
+	g_object_unref (masked_entry);
+
+	return allocated == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
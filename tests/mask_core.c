@@ -0,0 +1,485 @@
+/*
+ * MaskCore test
+ * Copyright (C) 2005-2014 Andrea Zagli <azagli@libero.it>
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this software; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <maskcore.h>
+
+static void
+test_compile (void)
+{
+	MaskCore *mask = mask_core_compile ("ABC 00@@@00");
+
+	g_assert (mask->length == 11);
+	g_assert (mask->n_writeable == 7);
+	g_assert (strcmp (mask->literals, "ABC _______") == 0);
+	g_assert (!MASK_CORE_IS_WRITEABLE (mask, 3));
+	g_assert (MASK_CORE_IS_WRITEABLE (mask, 4));
+	g_assert (mask->classes[6] == MASK_CORE_CLASS_ALPHA);
+	g_assert (mask->n_blocks == 1);
+	g_assert (mask->blocks[0].start == 4 && mask->blocks[0].end == 11);
+	g_assert (mask->slot_at[0] == 0 && mask->slot_at[4] == 0);
+	g_assert (mask->slot_at[6] == 2 && mask->slot_at[11] == 7);
+
+	mask_core_unref (mask);
+
+	/* one position for each character shown: no bytes of a UTF-8 sequence */
+	mask = mask_core_compile ("\xe2\x82\xac 000");
+	g_assert (mask->length == 5);
+	g_assert (mask->n_writeable == 3);
+	g_assert (strcmp (mask->literals, "? ___") == 0);
+	g_assert (strcmp (mask->text, "\xe2\x82\xac 000") == 0);
+
+	mask_core_unref (mask);
+}
+
+static void
+test_intern (void)
+{
+	MaskCore *a = mask_core_intern ("00/00/0000");
+	MaskCore *b = mask_core_intern ("00/00/0000");
+	MaskCore *c = mask_core_intern ("00:00");
+
+	g_assert (a == b);
+	g_assert (a != c);
+	g_assert (strcmp (a->literals, "__/__/____") == 0);
+
+	mask_core_unref (a);
+	mask_core_unref (c);
+	b = mask_core_intern ("00/00/0000");
+	g_assert (a == b);
+	mask_core_unref (b);
+	mask_core_unref (b);
+
+	/* gone with its last reference, compiled again */
+	a = mask_core_intern ("00/00/0000");
+	g_assert (a->ref_count == 1);
+	mask_core_unref (a);
+}
+
+static void
+test_blocks (void)
+{
+	MaskCore *mask = mask_core_compile ("00/00/0000");
+
+	g_assert (mask->n_blocks == 3);
+	g_assert (mask->blocks[1].start == 3 && mask->blocks[1].end == 5);
+
+	/* inside a block */
+	g_assert (mask->block_at[4] == 1);
+	g_assert (mask->next_block[4] == 6);
+	g_assert (mask->prev_block[4] == 0);
+
+	/* on a literal */
+	g_assert (mask->block_at[2] == -1);
+	g_assert (mask->next_block[2] == 3);
+	g_assert (mask->prev_block[2] == 0);
+
+	/* at the ends */
+	g_assert (mask->prev_block[0] == -1);
+	g_assert (mask->next_block[7] == -1);
+	g_assert (mask->next_block[10] == -1);
+	g_assert (mask->prev_block[10] == 6);
+
+	/* the first writeable position from any position */
+	g_assert (mask_core_get_first_writeable (mask, -1) == 0);
+	g_assert (mask_core_get_first_writeable (mask, 1) == 1);
+	g_assert (mask_core_get_first_writeable (mask, 2) == 3);
+	g_assert (mask_core_get_first_writeable (mask, 5) == 6);
+	g_assert (mask_core_get_first_writeable (mask, 10) == 10);
+	g_assert (mask_core_get_first_writeable (mask, 12) == 10);
+
+	mask_core_unref (mask);
+
+	/* a literal at the end */
+	mask = mask_core_compile ("(00)");
+	g_assert (mask_core_get_first_writeable (mask, 3) == 4);
+	mask_core_unref (mask);
+}
+
+static void
+test_validate (void)
+{
+	MaskCore *mask = mask_core_compile ("99-^^-#");
+
+	g_assert (mask_core_validate (mask, "12ab3", -1) == -1);
+	g_assert (mask_core_validate (mask, "10", -1) == 1);
+	g_assert (mask_core_validate (mask, "12a1", -1) == 3);
+	g_assert (mask_core_validate (mask, "12abc!", -1) == 5);
+	g_assert (mask_core_validate (mask, "12abcd", -1) == 5);
+
+	mask_core_unref (mask);
+}
+
+/* long enough to go through the vector kernels, with the refused character
+ * at every position and bytes out of ASCII */
+static void
+test_validate_long (void)
+{
+	MaskCore *mask;
+	GString *m = g_string_new (NULL);
+	gchar *raw, *text;
+	gint i, n;
+
+	for (i = 0; i < 100; i++)
+		{
+			g_string_append (m, i % 10 == 9 ? "-" : "#9@^0");
+		}
+	mask = mask_core_compile (m->str);
+	n = mask->n_writeable;
+
+	raw = g_new (gchar, MASK_CORE_UNFORMATTED_SIZE (mask));
+	text = g_new (gchar, MASK_CORE_FORMATTED_SIZE (mask));
+	for (i = 0; i < n; i++)
+		{
+			switch (mask->slot_classes[i])
+				{
+					case MASK_CORE_CLASS_DIGIT_NOT_ZERO:
+						raw[i] = '1' + i % 9;
+						break;
+
+					case MASK_CORE_CLASS_DIGIT:
+						raw[i] = '0' + i % 10;
+						break;
+
+					default:
+						raw[i] = (i % 2 ? 'a' : 'Z');
+						break;
+				}
+		}
+	raw[n] = '\0';
+
+	g_assert (mask_core_validate (mask, raw, -1) == -1);
+	g_assert (mask_core_format (mask, raw, -1, text) == n);
+	g_assert (mask_core_validate_formatted (mask, text, -1) == -1);
+
+	for (i = 0; i < n; i++)
+		{
+			gchar c = raw[i];
+
+			raw[i] = (mask->slot_classes[i] == MASK_CORE_CLASS_DIGIT_NOT_ZERO ? '0' : '!');
+			g_assert (mask_core_validate (mask, raw, -1) == i);
+			raw[i] = (gchar)0xe9;
+			g_assert (mask_core_validate (mask, raw, -1) == i);
+			raw[i] = c;
+		}
+
+	/* a literal out of place and a position not filled */
+	text[45] = 'x';
+	g_assert (mask_core_validate_formatted (mask, text, -1) == 45);
+	text[45] = '-';
+	text[m->len - 2] = MASK_CORE_PLACEHOLDER;
+	g_assert (mask_core_validate_formatted (mask, text, -1) == (gint)m->len - 2);
+	g_assert (mask_core_validate_formatted (mask, text, 5) == 5);
+
+	g_free (raw);
+	g_free (text);
+	g_string_free (m, TRUE);
+	mask_core_unref (mask);
+}
+
+static void
+test_format (void)
+{
+	MaskCore *mask = mask_core_compile ("(000) ^^-0");
+	gchar buffer[11];
+	gchar raw[7];
+
+	g_assert (mask_core_format (mask, "123ab4", -1, buffer) == 6);
+	g_assert (strcmp (buffer, "(123) AB-4") == 0);
+
+	g_assert (mask_core_format (mask, "12x", -1, buffer) == 2);
+	g_assert (strcmp (buffer, "(12_) __-_") == 0);
+
+	g_assert (mask_core_unformat (mask, "(123) AB-4", -1, raw) == 6);
+	g_assert (strcmp (raw, "123AB4") == 0);
+
+	g_assert (mask_core_unformat (mask, "(12_) __-_", -1, raw) == 2);
+	g_assert (strcmp (raw, "12") == 0);
+
+	/* the empty slots stay, and the refused characters leave theirs empty */
+	g_assert (mask_core_format_slots (mask, "1_3a14", -1, buffer) == 4);
+	g_assert (strcmp (buffer, "(1_3) A_-4") == 0);
+
+	mask_core_unref (mask);
+}
+
+static void
+test_batch (void)
+{
+	MaskCore *mask = mask_core_compile ("00/00/0000");
+	const gchar *raws[] = { "12052020", "0101", "3112199x" };
+	const gchar *packed = "120520200101";
+	const gsize offsets[] = { 0, 8, 12 };
+	const gchar *texts[3];
+	gchar *arena, *raw_arena;
+
+	arena = g_new (gchar, 3 * MASK_CORE_FORMATTED_SIZE (mask));
+	raw_arena = g_new (gchar, 3 * MASK_CORE_UNFORMATTED_SIZE (mask));
+
+	g_assert (mask_core_format_batch (mask, raws, 3, arena) == 2);
+	g_assert (strcmp (arena, "12/05/2020") == 0);
+	g_assert (strcmp (arena + MASK_CORE_FORMATTED_SIZE (mask), "01/01/____") == 0);
+	g_assert (strcmp (arena + 2 * MASK_CORE_FORMATTED_SIZE (mask), "31/12/199_") == 0);
+
+	texts[0] = arena;
+	texts[1] = arena + MASK_CORE_FORMATTED_SIZE (mask);
+	texts[2] = arena + 2 * MASK_CORE_FORMATTED_SIZE (mask);
+	mask_core_unformat_batch (mask, texts, 3, raw_arena);
+	g_assert (strcmp (raw_arena, "12052020") == 0);
+	g_assert (strcmp (raw_arena + MASK_CORE_UNFORMATTED_SIZE (mask), "0101") == 0);
+	g_assert (strcmp (raw_arena + 2 * MASK_CORE_UNFORMATTED_SIZE (mask), "3112199") == 0);
+
+	g_assert (mask_core_format_packed (mask, packed, offsets, 2, arena) == 2);
+	g_assert (strcmp (arena, "12/05/2020") == 0);
+	g_assert (strcmp (arena + MASK_CORE_FORMATTED_SIZE (mask), "01/01/____") == 0);
+
+	g_free (arena);
+	g_free (raw_arena);
+	mask_core_unref (mask);
+}
+
+static void
+test_keystrokes (void)
+{
+	MaskCore *mask = mask_core_compile ("00/00");
+	gchar text[6];
+	gchar buffer[6];
+	const gchar *erased;
+	gint pos, start, end;
+
+	strcpy (text, mask->literals);
+
+	pos = mask_core_apply_keystroke (mask, text, 0, '1');
+	g_assert (pos == 1);
+	pos = mask_core_apply_keystroke (mask, text, pos, '2');
+	g_assert (pos == 2);
+	/* the literal is skipped */
+	pos = mask_core_apply_keystroke (mask, text, pos, '3');
+	g_assert (pos == 4);
+	g_assert (mask_core_apply_keystroke (mask, text, pos, 'x') == -1);
+	g_assert (strcmp (text, "12/3_") == 0);
+
+	pos = 0;
+	g_assert (mask_core_insert (mask, "98/76", -1, &pos, buffer) == 5);
+	g_assert (pos == 0);
+	g_assert (strcmp (buffer, "98/76") == 0);
+
+	pos = 2;
+	g_assert (mask_core_insert (mask, "5", -1, &pos, buffer) == 1);
+	g_assert (pos == 3);
+
+	start = 1;
+	end = -1;
+	erased = mask_core_erase (mask, &start, &end);
+	g_assert (end == 5);
+	g_assert (strncmp (erased, "_/__", end - start) == 0);
+
+	start = 4;
+	end = 2;
+	g_assert (mask_core_erase (mask, &start, &end) == NULL);
+
+	mask_core_unref (mask);
+}
+
+/* the same value pasted with the mask, without it and with other
+ * separators */
+static void
+test_paste (void)
+{
+	MaskCore *mask = mask_core_compile ("00/00/0000");
+	MaskCore *iban = mask_core_compile ("^^00 #### #### #### #### ##");
+	gchar buffer[28];
+	gint pos;
+
+	pos = 0;
+	g_assert (mask_core_insert (mask, "12/05/2020", -1, &pos, buffer) == 10);
+	g_assert (strcmp (buffer, "12/05/2020") == 0);
+
+	pos = 0;
+	g_assert (mask_core_insert (mask, "12052020", -1, &pos, buffer) == 10);
+	g_assert (strcmp (buffer, "12/05/2020") == 0);
+
+	pos = 0;
+	g_assert (mask_core_insert (mask, "12-05-2020", -1, &pos, buffer) == 10);
+	g_assert (strcmp (buffer, "12/05/2020") == 0);
+
+	/* from a literal, and stopping at a character refused */
+	pos = 2;
+	g_assert (mask_core_insert (mask, "/0520", -1, &pos, buffer) == 5);
+	g_assert (pos == 3);
+	g_assert (strcmp (buffer, "05/20") == 0);
+	pos = 0;
+	g_assert (mask_core_insert (mask, "123x4", -1, &pos, buffer) == 4);
+	g_assert (strcmp (buffer, "12/3") == 0);
+
+	pos = 0;
+	g_assert (mask_core_insert (iban, "gb82 west 1234 5698 7654 32", -1, &pos, buffer) == 27);
+	g_assert (strcmp (buffer, "GB82 west 1234 5698 7654 32") == 0);
+	pos = 0;
+	g_assert (mask_core_insert (iban, "gb82west12345698765432", -1, &pos, buffer) == 27);
+	g_assert (strcmp (buffer, "GB82 west 1234 5698 7654 32") == 0);
+
+	mask_core_unref (mask);
+	mask_core_unref (iban);
+}
+
+static void
+test_set (void)
+{
+	MaskCoreSet *set = mask_core_set_new ();
+
+	g_assert (mask_core_set_lookup (set, "4", -1) == NULL);
+
+	/* without a mask for "", the first one */
+	mask_core_set_add (set, "4", "0000 0000 0000 0000");
+	mask_core_set_add (set, "34", "0000 000000 00000");
+	mask_core_set_add (set, "37", "0000 000000 00000");
+	g_assert (strcmp (mask_core_set_lookup (set, "", -1)->text, "0000 0000 0000 0000") == 0);
+	g_assert (strcmp (mask_core_set_lookup (set, "3", -1)->text, "0000 0000 0000 0000") == 0);
+
+	mask_core_set_add (set, "", "0000000000000000000");
+	g_assert (strcmp (mask_core_set_lookup (set, "", -1)->text, "0000000000000000000") == 0);
+	g_assert (strcmp (mask_core_set_lookup (set, "3", -1)->text, "0000000000000000000") == 0);
+	g_assert (strcmp (mask_core_set_lookup (set, "35", -1)->text, "0000000000000000000") == 0);
+	g_assert (strcmp (mask_core_set_lookup (set, "4111", -1)->text, "0000 0000 0000 0000") == 0);
+	g_assert (strcmp (mask_core_set_lookup (set, "3714", -1)->text, "0000 000000 00000") == 0);
+	g_assert (strcmp (mask_core_set_lookup (set, "3714", 1)->text, "0000000000000000000") == 0);
+
+	/* the same prefix again replaces its mask */
+	mask_core_set_add (set, "37", "0000-000000-00000");
+	g_assert (strcmp (mask_core_set_lookup (set, "37", -1)->text, "0000-000000-00000") == 0);
+	g_assert (strcmp (mask_core_set_lookup (set, "34", -1)->text, "0000 000000 00000") == 0);
+
+	mask_core_set_unref (set);
+}
+
+static void
+test_classes (void)
+{
+	MaskCore *mask, *plate, *hex;
+	gchar buffer[41];
+	gchar c;
+	gint pos;
+
+	/* hexadecimal digits, written in upper case */
+	g_assert (mask_core_register_class ('H', "0-9A-Fa-f", g_ascii_toupper));
+	g_assert (!mask_core_register_class ('H', "0-9", NULL));
+	g_assert (!mask_core_register_class ('0', "0-9", NULL));
+	g_assert (!mask_core_register_class (MASK_CORE_PLACEHOLDER, "0-9", NULL));
+	g_assert (!mask_core_register_class ('\xe9', "0-9", NULL));
+	/* the letters of vehicle plates, without I, O, Q and U */
+	g_assert (mask_core_register_class ('P', "A-HJ-NPR-TV-Z", NULL));
+	g_assert (mask_core_get_n_classes () == MASK_CORE_CLASS_CUSTOM + 2);
+
+	mask = mask_core_compile ("HH:HH:HH:HH:HH:HH");
+	g_assert (mask->n_writeable == 12);
+	g_assert (mask->classes[0] == MASK_CORE_CLASS_CUSTOM);
+	g_assert (mask_core_accept (mask, 0, 'e', &c) && c == 'E');
+	g_assert (!mask_core_accept (mask, 0, 'g', &c));
+	g_assert (mask_core_class_lookup (MASK_CORE_CLASS_CUSTOM, '7') == '7');
+	g_assert (mask_core_class_lookup (MASK_CORE_CLASS_CUSTOM, 'x') == '\0');
+	pos = 0;
+	g_assert (mask_core_insert (mask, "00-1a-2B-3c-4D-5e", -1, &pos, buffer) == 17);
+	g_assert (strcmp (buffer, "00:1A:2B:3C:4D:5E") == 0);
+
+	plate = mask_core_compile ("PP-000-PP");
+	g_assert (mask_core_validate (plate, "AB123CD", -1) == -1);
+	g_assert (mask_core_validate (plate, "AB123CO", -1) == 6);
+	g_assert (mask_core_validate (plate, "IB123CD", -1) == 0);
+
+	/* the vector kernels leave such classes to the scalar one */
+	hex = mask_core_compile ("HHHHHHHHHHHHHHHHHHHHHHHHHHHHHHHHHHHHHHHH");
+	g_assert (mask_core_validate (hex, "0123456789abcdefABCDEF0123456789abcdef01", -1) == -1);
+	g_assert (mask_core_validate (hex, "0123456789abcdefABCDEF0123456789abcdeg01", -1) == 37);
+	g_assert (mask_core_format (hex, "0123456789abcdefABCDEF0123456789abcdef01", -1, buffer) == 40);
+	g_assert (strcmp (buffer, "0123456789ABCDEFABCDEF0123456789ABCDEF01") == 0);
+
+	mask_core_unref (mask);
+	mask_core_unref (plate);
+	mask_core_unref (hex);
+}
+
+static void
+test_checksum (void)
+{
+	const gchar * const cards[] = { "4111111111111111", "4111111111111112", "411111111111111x" };
+	MaskCore *card = mask_core_compile ("0000 0000 0000 0000{luhn}");
+	MaskCore *iban = mask_core_compile ("^^00 #### #### #### #### ##{iban}");
+	gboolean valid[3];
+	const gchar *value;
+	gint i, state;
+
+	g_assert (card->checksum == MASK_CORE_CHECKSUM_LUHN);
+	g_assert (card->length == 19);
+	g_assert (strcmp (card->literals, "____ ____ ____ ____") == 0);
+	g_assert (strcmp (card->text, "0000 0000 0000 0000{luhn}") == 0);
+
+	g_assert (mask_core_check (card, "4111111111111111", -1));
+	g_assert (!mask_core_check (card, "4111111111111112", -1));
+	g_assert (!mask_core_check (card, "411111111111111", -1));
+	g_assert (mask_core_check_batch (card, cards, 3, valid) == 1);
+	g_assert (valid[0] && !valid[1] && !valid[2]);
+
+	g_assert (mask_core_check (iban, "GB82WEST12345698765432", -1));
+	g_assert (mask_core_check (iban, "gb82west12345698765432", -1));
+	g_assert (!mask_core_check (iban, "GB28WEST12345698765432", -1));
+
+	/* the state of a value typed one character after the other */
+	value = "GB82WEST12345698765432";
+	state = MASK_CORE_CHECK_INIT;
+	for (i = 0; value[i] != '\0'; i++)
+		{
+			state = mask_core_check_step (iban, state, i, value[i]);
+		}
+	g_assert (mask_core_check_finish (iban, state));
+
+	g_assert (mask_core_checksum_verify (MASK_CORE_CHECKSUM_LUHN, "79927398713", -1));
+	g_assert (!mask_core_checksum_verify (MASK_CORE_CHECKSUM_LUHN, "79927398710", -1));
+	g_assert (mask_core_checksum_verify (MASK_CORE_CHECKSUM_MOD_97_10, "5493001KJTIIGC8Y1R12", -1));
+	g_assert (!mask_core_checksum_verify (MASK_CORE_CHECKSUM_MOD_97_10, "5493001KJTIIGC8Y1R13", -1));
+	g_assert (mask_core_checksum_verify (MASK_CORE_CHECKSUM_MOD_11_2, "0000000121032683", -1));
+	g_assert (mask_core_checksum_verify (MASK_CORE_CHECKSUM_MOD_11_2, "000000029534656X", -1));
+	g_assert (!mask_core_checksum_verify (MASK_CORE_CHECKSUM_MOD_11_2, "0000000121032684", -1));
+
+	mask_core_unref (card);
+	mask_core_unref (iban);
+}
+
+int
+main (int argc, char **argv)
+{
+	test_compile ();
+	test_intern ();
+	test_blocks ();
+	test_validate ();
+	test_validate_long ();
+	test_format ();
+	test_batch ();
+	test_keystrokes ();
+	test_paste ();
+	test_set ();
+	test_classes ();
+	test_checksum ();
+
+	return 0;
+}
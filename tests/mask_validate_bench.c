@@ -0,0 +1,127 @@
+/*
+ * MaskCore validation benchmark
+ * Copyright (C) 2005-2014 Andrea Zagli <azagli@libero.it>
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this software; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <maskcore.h>
+
+/* characters validated for every mask length */
+#define CHARACTERS (64 * 1024 * 1024)
+
+/* validation as the widget did it, one character at a time */
+static gint
+validate_per_char (const MaskCore *mask, const gchar *text, gint length)
+{
+	gint i;
+	gchar accepted;
+
+	for (i = 0; i < length; i++)
+		{
+			if (MASK_CORE_IS_WRITEABLE (mask, i))
+				{
+					if (!mask_core_accept (mask, i, text[i], &accepted))
+						{
+							return i;
+						}
+				}
+			else if (text[i] != mask->literals[i])
+				{
+					return i;
+				}
+		}
+
+	return -1;
+}
+
+static void
+bench (gint length)
+{
+	const gchar *pattern = "000.000.000-##/^^^@@@ 9999";
+	GString *m = g_string_sized_new (length);
+	MaskCore *mask;
+	gchar *raw, *text;
+	GTimer *timer;
+	gdouble per_char, kernel;
+	gint i, n, rounds, ret = 0;
+
+	for (i = 0; i < length; i++)
+		{
+			g_string_append_c (m, pattern[i % strlen (pattern)]);
+		}
+	mask = mask_core_compile (m->str);
+
+	raw = g_new (gchar, MASK_CORE_UNFORMATTED_SIZE (mask));
+	text = g_new (gchar, MASK_CORE_FORMATTED_SIZE (mask));
+	for (i = 0; i < mask->n_writeable; i++)
+		{
+			raw[i] = (mask->slot_classes[i] >= MASK_CORE_CLASS_ALPHA ? 'K' : '7');
+		}
+	raw[mask->n_writeable] = '\0';
+	n = mask_core_format (mask, raw, -1, text);
+	g_assert (n == mask->n_writeable);
+
+	rounds = CHARACTERS / length;
+	timer = g_timer_new ();
+
+	for (i = 0; i < rounds; i++)
+		{
+			ret += validate_per_char (mask, text, length);
+		}
+	per_char = g_timer_elapsed (timer, NULL);
+
+	g_timer_start (timer);
+	for (i = 0; i < rounds; i++)
+		{
+			ret += mask_core_validate_formatted (mask, text, length);
+		}
+	kernel = g_timer_elapsed (timer, NULL);
+
+	/* every text is valid: ret keeps the loops from being optimized away */
+	g_assert (ret == -2 * rounds);
+
+	g_print ("%6d  %10.1f  %10.1f  %6.1fx\n",
+	         length,
+	         CHARACTERS / per_char / 1e6,
+	         CHARACTERS / kernel / 1e6,
+	         per_char / kernel);
+
+	g_timer_destroy (timer);
+	g_free (raw);
+	g_free (text);
+	g_string_free (m, TRUE);
+	mask_core_unref (mask);
+}
+
+int
+main (int argc, char **argv)
+{
+	const gint lengths[] = { 10, 16, 64, 256, 1024, 4096 };
+	guint i;
+
+	g_print ("length  per-char (Mchar/s)  kernel (Mchar/s)  speedup\n");
+	for (i = 0; i < G_N_ELEMENTS (lengths); i++)
+		{
+			bench (lengths[i]);
+		}
+
+	return 0;
+}
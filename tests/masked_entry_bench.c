@@ -0,0 +1,704 @@
+/*
+ * GtkMaskedEntry benchmark
+ * Copyright (C) 2005-2014 Andrea Zagli <azagli@libero.it>
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this software; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef __GLIBC__
+	#include <malloc.h>
+#endif
+
+#include <gtk/gtk.h>
+
+#include <maskcore.h>
+#include <gtkmaskedentrybuffer.h>
+#include <gtkmaskedentry.h>
+#include <gtkcellrenderermasked.h>
+#include <gtkmaskedkeys.h>
+#include <gtkmaskedlabel.h>
+
+/* a screen with many fields */
+#define ENTRIES 500
+
+#define KEYSTROKES 100000
+
+/* a big form, for the memory footprint */
+#define WIDGETS 10000
+
+/* a long list, scrolled a page at a time, down and back up */
+#define ROWS 500000
+#define PAGE 40
+
+/* a mixed column, as phone numbers of many countries */
+#define MIXED_ROWS 100000
+#define MASKS 20
+
+/* a dashboard of values never edited */
+#define LABELS 5000
+
+/* a long list sorted by a masked date */
+#define SORTED_ROWS 1000000
+
+/* bench_mask_switch */
+#define MASK_SWITCHES 100000
+
+/* bench_mask_set */
+#define ALTERNATIVES 1000
+
+/* bench_form */
+#define FIELDS 80
+#define FORM_CHECKS 10000
+
+/* bench_checksum */
+#define IBAN "GB82WEST12345698765432"
+
+/* the bytes of the heap in use, or 0 where it cannot be known */
+static gsize
+heap_in_use (void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	return mallinfo2 ().uordblks;
+#elif defined(__GLIBC__)
+	return (guint)mallinfo ().uordblks;
+#else
+	return 0;
+#endif
+}
+
+static void
+bench_creation (void)
+{
+	GtkWidget *entries[ENTRIES];
+	GTimer *timer;
+	gdouble elapsed;
+	guint i;
+
+	timer = g_timer_new ();
+	for (i = 0; i < ENTRIES; i++)
+		{
+			entries[i] = gtk_masked_entry_new_with_mask ("00/00/0000");
+			g_object_ref_sink (entries[i]);
+		}
+	elapsed = g_timer_elapsed (timer, NULL);
+
+	g_print ("creation: %u entries in %.2f ms, %.2f us each\n",
+	         ENTRIES, elapsed * 1e3, elapsed * 1e6 / ENTRIES);
+
+	for (i = 0; i < ENTRIES; i++)
+		{
+			g_object_unref (entries[i]);
+		}
+	g_timer_destroy (timer);
+}
+
+static void
+bench_keystrokes (void)
+{
+	GtkWidget *masked_entry;
+	GtkEditable *editable;
+	GTimer *timer;
+	gdouble elapsed;
+	gint pos = 0;
+	guint i;
+
+	masked_entry = gtk_masked_entry_new_with_mask ("00/00/0000");
+	g_object_ref_sink (masked_entry);
+	editable = GTK_EDITABLE (masked_entry);
+
+	timer = g_timer_new ();
+	for (i = 0; i < KEYSTROKES; i++)
+		{
+			if (pos >= 10)
+				{
+					gtk_editable_delete_text (editable, 0, -1);
+					pos = 0;
+				}
+			gtk_editable_insert_text (editable, "7", 1, &pos);
+		}
+	elapsed = g_timer_elapsed (timer, NULL);
+
+	g_print ("keystrokes: %u in %.2f ms, %.3f us each\n",
+	         KEYSTROKES, elapsed * 1e3, elapsed * 1e6 / KEYSTROKES);
+
+	g_timer_destroy (timer);
+	g_object_unref (masked_entry);
+}
+
+static void
+bench_mask_switch (void)
+{
+	const gchar *masks[] = { "(000) 000-0000", "000.000.0000" };
+	GtkWidget *masked_entry;
+	GTimer *timer;
+	gdouble elapsed;
+	guint i;
+
+	masked_entry = gtk_masked_entry_new_with_mask (masks[1]);
+	g_object_ref_sink (masked_entry);
+	gtk_masked_entry_set_text (GTK_MASKED_ENTRY (masked_entry), "2025550123");
+
+	timer = g_timer_new ();
+	for (i = 0; i < MASK_SWITCHES; i++)
+		{
+			gtk_masked_entry_set_mask (GTK_MASKED_ENTRY (masked_entry), masks[i % 2]);
+		}
+	elapsed = g_timer_elapsed (timer, NULL);
+	g_assert (strcmp (gtk_masked_entry_get_text (GTK_MASKED_ENTRY (masked_entry)), "2025550123") == 0);
+
+	g_print ("mask switches: %u in %.2f ms, %.3f us each\n",
+	         MASK_SWITCHES, elapsed * 1e3, elapsed * 1e6 / MASK_SWITCHES);
+
+	g_timer_destroy (timer);
+	g_object_unref (masked_entry);
+}
+
+static gdouble
+type_cards (guint alternatives)
+{
+	const gchar *card = "4111111111111111";
+	GtkWidget *masked_entry;
+	GtkEditable *editable;
+	GTimer *timer;
+	gdouble elapsed;
+	gchar prefix[5];
+	gint pos = 0;
+	guint i;
+
+	masked_entry = gtk_masked_entry_new_with_mask ("0000 0000 0000 0000");
+	g_object_ref_sink (masked_entry);
+	editable = GTK_EDITABLE (masked_entry);
+	for (i = 0; i < alternatives; i++)
+		{
+			g_snprintf (prefix, sizeof (prefix), "%04u", 5000 + i);
+			gtk_masked_entry_add_mask (GTK_MASKED_ENTRY (masked_entry), prefix,
+			                           i % 2 == 0 ? "0000 000000 00000" : "0000-0000-0000-0000");
+		}
+	gtk_masked_entry_add_mask (GTK_MASKED_ENTRY (masked_entry), "4", "0000-0000-0000-0000");
+
+	timer = g_timer_new ();
+	for (i = 0; i < KEYSTROKES; i++)
+		{
+			if (pos >= 19)
+				{
+					gtk_editable_delete_text (editable, 0, -1);
+					pos = 0;
+				}
+			gtk_editable_insert_text (editable, card + (i % 16), 1, &pos);
+		}
+	elapsed = g_timer_elapsed (timer, NULL);
+
+	g_timer_destroy (timer);
+	g_object_unref (masked_entry);
+
+	return elapsed;
+}
+
+static void
+bench_mask_set (void)
+{
+	gdouble few, many;
+
+	few = type_cards (2);
+	many = type_cards (ALTERNATIVES);
+
+	g_print ("alternative masks: %u keystrokes, %.3f us each with 2 masks, %.3f us each with %u\n",
+	         KEYSTROKES, few * 1e6 / KEYSTROKES, many * 1e6 / KEYSTROKES, ALTERNATIVES);
+}
+
+/* the validation after the fact, on the whole value at every change */
+static void
+recheck (GtkEditable *editable, gpointer valid)
+{
+	GtkMaskedEntry *masked_entry = GTK_MASKED_ENTRY (editable);
+	GtkEntryBuffer *buffer = gtk_entry_get_buffer (GTK_ENTRY (masked_entry));
+
+	*(gboolean *)valid = mask_core_check (gtk_masked_entry_buffer_get_mask (GTK_MASKED_ENTRY_BUFFER (buffer)),
+	                                      gtk_masked_entry_get_text (masked_entry), -1);
+}
+
+static gdouble
+type_ibans (gboolean incremental)
+{
+	GtkWidget *masked_entry;
+	GtkEditable *editable;
+	GTimer *timer;
+	gdouble elapsed;
+	gboolean valid = FALSE;
+	guint i, valids = 0;
+	gint pos = 0;
+
+	masked_entry = gtk_masked_entry_new_with_mask ("^^00 #### #### #### #### ##{iban}");
+	g_object_ref_sink (masked_entry);
+	editable = GTK_EDITABLE (masked_entry);
+	if (!incremental)
+		{
+			g_signal_connect (G_OBJECT (masked_entry), "changed", G_CALLBACK (recheck), &valid);
+		}
+
+	timer = g_timer_new ();
+	for (i = 0; i < KEYSTROKES; i++)
+		{
+			if (i % 22 == 0)
+				{
+					gtk_editable_delete_text (editable, 0, -1);
+					pos = 0;
+				}
+			gtk_editable_insert_text (editable, IBAN + (i % 22), 1, &pos);
+			if (incremental)
+				{
+					valid = gtk_masked_entry_get_valid (GTK_MASKED_ENTRY (masked_entry));
+				}
+			valids += valid;
+		}
+	elapsed = g_timer_elapsed (timer, NULL);
+	g_assert (valids == KEYSTROKES / 22);
+
+	g_timer_destroy (timer);
+	g_object_unref (masked_entry);
+
+	return elapsed;
+}
+
+static void
+bench_checksum (void)
+{
+	gdouble rescan, incremental;
+
+	rescan = type_ibans (FALSE);
+	incremental = type_ibans (TRUE);
+
+	g_print ("check digits: %u keystrokes, %.3f us each rescanning, %.3f us each kept\n",
+	         KEYSTROKES, rescan * 1e6 / KEYSTROKES, incremental * 1e6 / KEYSTROKES);
+}
+
+/* the completeness as it was asked, counting the placeholders shown */
+static gint
+count_unfilled (GtkWidget *masked_entry)
+{
+	const gchar *text = gtk_entry_get_text (GTK_ENTRY (masked_entry));
+	gint n = 0;
+
+	for (; *text != '\0'; text++)
+		{
+			n += (*text == '_');
+		}
+
+	return n;
+}
+
+static void
+bench_form (void)
+{
+	GtkWidget *fields[FIELDS];
+	GTimer *timer;
+	gdouble counting, summing;
+	gint unfilled = 0, filled = 0;
+	guint i, f;
+
+	for (f = 0; f < FIELDS; f++)
+		{
+			fields[f] = gtk_masked_entry_new_with_mask ("(000) 000-0000");
+			g_object_ref_sink (fields[f]);
+			gtk_masked_entry_set_text (GTK_MASKED_ENTRY (fields[f]), f % 2 == 0 ? "2025550123" : "202555");
+		}
+
+	timer = g_timer_new ();
+	for (i = 0; i < FORM_CHECKS; i++)
+		{
+			for (f = 0; f < FIELDS; f++)
+				{
+					unfilled += count_unfilled (fields[f]);
+				}
+		}
+	counting = g_timer_elapsed (timer, NULL);
+
+	g_timer_start (timer);
+	for (i = 0; i < FORM_CHECKS; i++)
+		{
+			for (f = 0; f < FIELDS; f++)
+				{
+					filled += gtk_masked_entry_get_filled_count (GTK_MASKED_ENTRY (fields[f]));
+				}
+		}
+	summing = g_timer_elapsed (timer, NULL);
+	g_assert (unfilled + filled == FORM_CHECKS * FIELDS * 10);
+
+	g_print ("form of %u fields: %.3f us counting placeholders, %.3f us summing filled counts\n",
+	         FIELDS, counting * 1e6 / FORM_CHECKS, summing * 1e6 / FORM_CHECKS);
+
+	g_timer_destroy (timer);
+	for (f = 0; f < FIELDS; f++)
+		{
+			g_object_unref (fields[f]);
+		}
+}
+
+static void
+bench_footprint (void)
+{
+	MaskCore **masks;
+	GtkWidget **widgets;
+	gsize start, compiled, interned;
+	guint i;
+
+	/* the masks alone: one copy each, as every widget used to keep, and
+	 * then one shared */
+	masks = g_new (MaskCore *, WIDGETS);
+
+	start = heap_in_use ();
+	for (i = 0; i < WIDGETS; i++)
+		{
+			masks[i] = mask_core_compile ("00/00/0000");
+		}
+	compiled = heap_in_use () - start;
+	for (i = 0; i < WIDGETS; i++)
+		{
+			mask_core_unref (masks[i]);
+		}
+
+	start = heap_in_use ();
+	for (i = 0; i < WIDGETS; i++)
+		{
+			masks[i] = mask_core_intern ("00/00/0000");
+		}
+	interned = heap_in_use () - start;
+	for (i = 0; i < WIDGETS; i++)
+		{
+			mask_core_unref (masks[i]);
+		}
+
+	g_print ("masks: %u compiled %" G_GSIZE_FORMAT " bytes, %u interned %" G_GSIZE_FORMAT " bytes\n",
+	         WIDGETS, compiled, WIDGETS, interned);
+
+	g_free (masks);
+
+	/* the widgets */
+	widgets = g_new (GtkWidget *, WIDGETS);
+
+	start = heap_in_use ();
+	for (i = 0; i < WIDGETS; i++)
+		{
+			widgets[i] = gtk_masked_entry_new_with_mask ("00/00/0000");
+			g_object_ref_sink (widgets[i]);
+		}
+	g_print ("widgets: %u entries %" G_GSIZE_FORMAT " bytes, %" G_GSIZE_FORMAT " each\n",
+	         WIDGETS, heap_in_use () - start, (heap_in_use () - start) / WIDGETS);
+
+	for (i = 0; i < WIDGETS; i++)
+		{
+			g_object_unref (widgets[i]);
+		}
+	g_free (widgets);
+}
+
+static gdouble
+scroll (GtkTreeViewColumn *column, GtkTreeModel *model, GtkTreeIter *iters, gint rows)
+{
+	GTimer *timer;
+	gdouble elapsed;
+	gint i, j;
+
+	timer = g_timer_new ();
+	for (i = 0; i + PAGE <= rows; i += PAGE / 2)
+		{
+			for (j = i; j < i + PAGE; j++)
+				{
+					gtk_tree_view_column_cell_set_cell_data (column, model, &iters[j], FALSE, FALSE);
+				}
+		}
+	for (i = rows - PAGE; i >= 0; i -= PAGE / 2)
+		{
+			for (j = i; j < i + PAGE; j++)
+				{
+					gtk_tree_view_column_cell_set_cell_data (column, model, &iters[j], FALSE, FALSE);
+				}
+		}
+	elapsed = g_timer_elapsed (timer, NULL);
+	g_timer_destroy (timer);
+
+	return elapsed;
+}
+
+static void
+bench_renderer (void)
+{
+	GtkListStore *store;
+	GtkTreeViewColumn *column;
+	GtkCellRenderer *renderer;
+	GtkTreeIter *iters;
+	gchar raw[9];
+	gdouble cached, uncached;
+	gint i;
+
+	store = gtk_list_store_new (1, G_TYPE_STRING);
+	iters = g_new (GtkTreeIter, ROWS);
+	for (i = 0; i < ROWS; i++)
+		{
+			g_snprintf (raw, sizeof (raw), "%08d", i);
+			gtk_list_store_insert_with_values (store, &iters[i], i, 0, raw, -1);
+		}
+
+	renderer = gtk_cell_renderer_masked_new_with_mask ("00/00/0000");
+	column = gtk_tree_view_column_new ();
+	g_object_ref_sink (column);
+	gtk_tree_view_column_pack_start (column, renderer, TRUE);
+	gtk_cell_renderer_masked_set_raw_column (GTK_CELL_RENDERER_MASKED (renderer), column, 0);
+
+	cached = scroll (column, GTK_TREE_MODEL (store), iters, ROWS);
+	g_object_set (G_OBJECT (renderer), "cache-size", 0, NULL);
+	uncached = scroll (column, GTK_TREE_MODEL (store), iters, ROWS);
+
+	g_print ("renderer: %d rows scrolled, %.2f ms with the cache, %.2f ms without\n",
+	         ROWS, cached * 1e3, uncached * 1e3);
+
+	g_object_unref (column);
+	g_object_unref (store);
+	g_free (iters);
+}
+
+/* the mask of every row set from a cell data function, as it had to be done */
+static void
+set_mask_data_func (GtkTreeViewColumn *column,
+                    GtkCellRenderer *cell,
+                    GtkTreeModel *model,
+                    GtkTreeIter *iter,
+                    gpointer data)
+{
+	gchar *raw, *mask;
+
+	gtk_tree_model_get (model, iter, 0, &raw, 1, &mask, -1);
+	gtk_cell_renderer_masked_set_mask (GTK_CELL_RENDERER_MASKED (cell), mask);
+	g_object_set (G_OBJECT (cell), "raw-text", raw, NULL);
+	g_free (raw);
+	g_free (mask);
+}
+
+static void
+bench_row_masks (void)
+{
+	GtkListStore *store;
+	GtkTreeViewColumn *column;
+	GtkCellRenderer *renderer;
+	GtkTreeIter *iters;
+	gchar *masks[MASKS];
+	gchar raw[16];
+	gdouble set_mask, row_mask, row_mask_cached;
+	gint i;
+
+	for (i = 0; i < MASKS; i++)
+		{
+			masks[i] = g_strdup_printf ("+%02d (000) 000-%0*d", i + 1, 4 + i % 3, 0);
+		}
+
+	store = gtk_list_store_new (2, G_TYPE_STRING, G_TYPE_STRING);
+	iters = g_new (GtkTreeIter, MIXED_ROWS);
+	for (i = 0; i < MIXED_ROWS; i++)
+		{
+			g_snprintf (raw, sizeof (raw), "%012d", i);
+			gtk_list_store_insert_with_values (store, &iters[i], i,
+			                                   0, raw,
+			                                   1, masks[(i * 7) % MASKS],
+			                                   -1);
+		}
+
+	renderer = gtk_cell_renderer_masked_new ();
+	column = gtk_tree_view_column_new ();
+	g_object_ref_sink (column);
+	gtk_tree_view_column_pack_start (column, renderer, TRUE);
+	gtk_tree_view_column_set_cell_data_func (column, renderer, set_mask_data_func, NULL, NULL);
+	set_mask = scroll (column, GTK_TREE_MODEL (store), iters, MIXED_ROWS);
+
+	gtk_tree_view_column_add_attribute (column, renderer, "row-mask", 1);
+	gtk_cell_renderer_masked_set_raw_column (GTK_CELL_RENDERER_MASKED (renderer), column, 0);
+	row_mask_cached = scroll (column, GTK_TREE_MODEL (store), iters, MIXED_ROWS);
+	g_object_set (G_OBJECT (renderer), "cache-size", 0, NULL);
+	row_mask = scroll (column, GTK_TREE_MODEL (store), iters, MIXED_ROWS);
+
+	g_print ("row masks: %d rows with %d masks scrolled, %.2f ms setting the mask, "
+	         "%.2f ms with \"row-mask\", %.2f ms with \"row-mask\" and the cache\n",
+	         MIXED_ROWS, MASKS, set_mask * 1e3, row_mask * 1e3, row_mask_cached * 1e3);
+
+	g_object_unref (column);
+	g_object_unref (store);
+	g_free (iters);
+	for (i = 0; i < MASKS; i++)
+		{
+			g_free (masks[i]);
+		}
+}
+
+/* the comparison written by hand: the values without the mask at every
+ * comparison */
+static gint
+unmask_compare (GtkTreeModel *model, GtkTreeIter *a, GtkTreeIter *b, gpointer data)
+{
+	MaskCore *mask = data;
+	gchar *text_a, *text_b, *raw_a, *raw_b;
+	gint ret;
+
+	gtk_tree_model_get (model, a, 0, &text_a, -1);
+	gtk_tree_model_get (model, b, 0, &text_b, -1);
+	raw_a = g_new (gchar, MASK_CORE_UNFORMATTED_SIZE (mask));
+	raw_b = g_new (gchar, MASK_CORE_UNFORMATTED_SIZE (mask));
+	mask_core_unformat (mask, text_a, -1, raw_a);
+	mask_core_unformat (mask, text_b, -1, raw_b);
+
+	ret = strcmp (raw_a, raw_b);
+
+	g_free (text_a);
+	g_free (text_b);
+	g_free (raw_a);
+	g_free (raw_b);
+
+	return ret;
+}
+
+static gdouble
+sort (GtkListStore *store, GtkTreeIterCompareFunc func, gpointer data, GDestroyNotify destroy)
+{
+	GTimer *timer;
+	gdouble elapsed;
+
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store),
+	                                      GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID,
+	                                      GTK_SORT_ASCENDING);
+	gtk_tree_sortable_set_sort_func (GTK_TREE_SORTABLE (store), 0, func, data, destroy);
+
+	timer = g_timer_new ();
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), 0, GTK_SORT_ASCENDING);
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), 0, GTK_SORT_DESCENDING);
+	elapsed = g_timer_elapsed (timer, NULL);
+	g_timer_destroy (timer);
+
+	return elapsed;
+}
+
+static void
+bench_sort (void)
+{
+	GtkListStore *store;
+	MaskCore *mask;
+	GRand *rand;
+	gchar text[11];
+	gdouble by_hand, keys;
+	gint i;
+
+	rand = g_rand_new_with_seed (1);
+	store = gtk_list_store_new (1, G_TYPE_STRING);
+	for (i = 0; i < SORTED_ROWS; i++)
+		{
+			g_snprintf (text, sizeof (text), "%02d/%02d/%04d",
+			            g_rand_int_range (rand, 1, 29),
+			            g_rand_int_range (rand, 1, 13),
+			            g_rand_int_range (rand, 1900, 2100));
+			gtk_list_store_insert_with_values (store, NULL, -1, 0, text, -1);
+		}
+
+	mask = mask_core_intern ("00/00/0000");
+	by_hand = sort (store, unmask_compare, mask, NULL);
+	keys = sort (store, gtk_masked_keys_compare,
+	             gtk_masked_keys_new ("00/00/0000", 0, TRUE),
+	             (GDestroyNotify)gtk_masked_keys_unref);
+
+	g_print ("sort: %d rows sorted up and down, %.2f ms unmasking at every comparison, "
+	         "%.2f ms with GtkMaskedKeys\n",
+	         SORTED_ROWS, by_hand * 1e3, keys * 1e3);
+
+	g_object_unref (store);
+	mask_core_unref (mask);
+	g_rand_free (rand);
+}
+
+static void
+bench_labels (void)
+{
+	GtkWidget **widgets;
+	GTimer *timer;
+	gdouble entries_time, labels_time;
+	gsize start, entries_size, labels_size;
+	gchar raw[9];
+	guint i;
+
+	widgets = g_new (GtkWidget *, LABELS);
+	timer = g_timer_new ();
+
+	start = heap_in_use ();
+	g_timer_start (timer);
+	for (i = 0; i < LABELS; i++)
+		{
+			g_snprintf (raw, sizeof (raw), "%08u", i);
+			widgets[i] = gtk_masked_entry_new_with_mask ("00/00/0000");
+			g_object_ref_sink (widgets[i]);
+			gtk_masked_entry_set_text (GTK_MASKED_ENTRY (widgets[i]), raw);
+		}
+	entries_time = g_timer_elapsed (timer, NULL);
+	entries_size = heap_in_use () - start;
+	for (i = 0; i < LABELS; i++)
+		{
+			g_object_unref (widgets[i]);
+		}
+
+	start = heap_in_use ();
+	g_timer_start (timer);
+	for (i = 0; i < LABELS; i++)
+		{
+			g_snprintf (raw, sizeof (raw), "%08u", i);
+			widgets[i] = gtk_masked_label_new ("00/00/0000", raw);
+			g_object_ref_sink (widgets[i]);
+		}
+	labels_time = g_timer_elapsed (timer, NULL);
+	labels_size = heap_in_use () - start;
+	for (i = 0; i < LABELS; i++)
+		{
+			g_object_unref (widgets[i]);
+		}
+
+	g_print ("labels: %u entries in %.2f ms, %" G_GSIZE_FORMAT " bytes each; "
+	         "%u labels in %.2f ms, %" G_GSIZE_FORMAT " bytes each\n",
+	         LABELS, entries_time * 1e3, entries_size / LABELS,
+	         LABELS, labels_time * 1e3, labels_size / LABELS);
+
+	g_timer_destroy (timer);
+	g_free (widgets);
+}
+
+int
+main (int argc, char **argv)
+{
+	g_setenv ("NO_AT_BRIDGE", "1", TRUE);
+	if (!gtk_init_check (&argc, &argv))
+		{
+			g_printerr ("Unable to initialize GTK+.\n");
+			return 1;
+		}
+
+	bench_creation ();
+	bench_keystrokes ();
+	bench_mask_switch ();
+	bench_mask_set ();
+	bench_checksum ();
+	bench_form ();
+	bench_footprint ();
+	bench_labels ();
+	bench_renderer ();
+	bench_row_masks ();
+	bench_sort ();
+
+	return 0;
+}
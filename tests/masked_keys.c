@@ -0,0 +1,120 @@
+/*
+ * GtkMaskedKeys test
+ * Copyright (C) 2005-2014 Andrea Zagli <azagli@libero.it>
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this software; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+
+#include <gtk/gtk.h>
+
+#include <gtkmaskedkeys.h>
+
+/* the values of the column, in the order of the model */
+static void
+check_order (GtkTreeModel *model, const gchar * const *expected)
+{
+	GtkTreeIter iter;
+	gchar *value;
+	gint i = 0;
+
+	if (gtk_tree_model_get_iter_first (model, &iter))
+		{
+			do
+				{
+					gtk_tree_model_get (model, &iter, 0, &value, -1);
+					g_assert (strcmp (value, expected[i++]) == 0);
+					g_free (value);
+				}
+			while (gtk_tree_model_iter_next (model, &iter));
+		}
+	g_assert (expected[i] == NULL);
+}
+
+static void
+test_compare (void)
+{
+	const gchar * const sorted[] = { "(01_) ___-____", "(012) 555-0199",
+	                                 "(202) 555-0123", "(212) 555-0001", NULL };
+	const gchar * const resorted[] = { "(01_) ___-____", "(202) 555-0123",
+	                                   "(212) 555-0001", "(999) 000-0000", NULL };
+	const gchar * const moved[] = { "(000) 111-2222", "(01_) ___-____",
+	                                "(202) 555-0123", "(212) 555-0001", NULL };
+	GtkListStore *store;
+	GtkMaskedKeys *keys;
+	GtkTreeIter iter;
+
+	store = gtk_list_store_new (1, G_TYPE_STRING);
+	gtk_list_store_insert_with_values (store, NULL, -1, 0, "(212) 555-0001", -1);
+	gtk_list_store_insert_with_values (store, &iter, -1, 0, "(012) 555-0199", -1);
+	gtk_list_store_insert_with_values (store, NULL, -1, 0, "(01_) ___-____", -1);
+	gtk_list_store_insert_with_values (store, NULL, -1, 0, "(202) 555-0123", -1);
+
+	keys = gtk_masked_keys_new ("(000) 000-0000", 0, TRUE);
+	gtk_tree_sortable_set_sort_func (GTK_TREE_SORTABLE (store), 0,
+	                                 gtk_masked_keys_compare,
+	                                 keys, (GDestroyNotify)gtk_masked_keys_unref);
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), 0, GTK_SORT_ASCENDING);
+	check_order (GTK_TREE_MODEL (store), sorted);
+
+	/* a row changed is sorted again by its new value, before the store
+	 * emits "row-changed" */
+	gtk_list_store_set (store, &iter, 0, "(999) 000-0000", -1);
+	check_order (GTK_TREE_MODEL (store), resorted);
+	gtk_list_store_set (store, &iter, 0, "(000) 111-2222", -1);
+	check_order (GTK_TREE_MODEL (store), moved);
+
+	g_object_unref (store);
+}
+
+static void
+test_search_equal (void)
+{
+	GtkListStore *store;
+	GtkTreeModel *model;
+	GtkMaskedKeys *keys;
+	GtkTreeIter iter;
+
+	store = gtk_list_store_new (1, G_TYPE_STRING);
+	model = GTK_TREE_MODEL (store);
+	gtk_list_store_insert_with_values (store, &iter, -1, 0, "AB12CD", -1);
+
+	/* the values in the model without the mask */
+	keys = gtk_masked_keys_new ("^^-00-^^", 0, FALSE);
+
+	g_assert (!gtk_masked_keys_search_equal (model, 0, "", &iter, keys));
+	g_assert (!gtk_masked_keys_search_equal (model, 0, "ab1", &iter, keys));
+	g_assert (!gtk_masked_keys_search_equal (model, 0, "AB-12-c", &iter, keys));
+	g_assert (gtk_masked_keys_search_equal (model, 0, "B", &iter, keys));
+	g_assert (gtk_masked_keys_search_equal (model, 0, "AB12CDE", &iter, keys));
+
+	gtk_masked_keys_unref (keys);
+	g_object_unref (store);
+}
+
+int
+main (int argc, char **argv)
+{
+#if !GLIB_CHECK_VERSION (2, 36, 0)
+	g_type_init ();
+#endif
+
+	test_compare ();
+	test_search_equal ();
+
+	return 0;
+}
@@ -0,0 +1,81 @@
+/*
+ * GtkMaskedLabel test
+ * Copyright (C) 2005-2014 Andrea Zagli <azagli@libero.it>
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this software; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+
+#include <gtk/gtk.h>
+
+#include <gtkmaskedlabel.h>
+
+/* exit status that automake's test driver reports as skipped */
+#define EXIT_SKIP 77
+
+static guint raw_text_notified = 0;
+
+static void
+on_raw_text_notify (GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	raw_text_notified++;
+}
+
+int
+main (int argc, char **argv)
+{
+	GtkWidget *masked_label;
+	GtkLabel *label;
+	gchar *raw;
+
+	g_setenv ("NO_AT_BRIDGE", "1", TRUE);
+	if (!gtk_init_check (&argc, &argv))
+		{
+			g_printerr ("Unable to initialize GTK+.\n");
+			return EXIT_SKIP;
+		}
+
+	masked_label = gtk_masked_label_new ("00/00/0000", "12052020");
+	g_object_ref_sink (masked_label);
+	label = GTK_LABEL (masked_label);
+	g_assert (strcmp (gtk_label_get_text (label), "12/05/2020") == 0);
+
+	g_signal_connect (G_OBJECT (masked_label), "notify::raw-text",
+	                  G_CALLBACK (on_raw_text_notify), NULL);
+
+	/* not complete, and then empty */
+	gtk_masked_label_set_text (GTK_MASKED_LABEL (masked_label), "0101");
+	g_assert (strcmp (gtk_label_get_text (label), "01/01/____") == 0);
+	g_assert (raw_text_notified == 1);
+	gtk_masked_label_set_text (GTK_MASKED_LABEL (masked_label), "0101");
+	g_assert (raw_text_notified == 1);
+	g_object_set (G_OBJECT (masked_label), "raw-text", NULL, NULL);
+	g_assert (strcmp (gtk_label_get_text (label), "") == 0);
+	g_assert (raw_text_notified == 2);
+
+	/* the value formatted again with another mask */
+	gtk_masked_label_set_text (GTK_MASKED_LABEL (masked_label), "1230");
+	gtk_masked_label_set_mask (GTK_MASKED_LABEL (masked_label), "00:00");
+	g_assert (strcmp (gtk_label_get_text (label), "12:30") == 0);
+	g_object_get (G_OBJECT (masked_label), "raw-text", &raw, NULL);
+	g_assert (strcmp (raw, "1230") == 0);
+	g_free (raw);
+
+	g_object_unref (masked_label);
+
+	return 0;
+}